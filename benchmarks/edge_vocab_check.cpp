@@ -0,0 +1,248 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "nemo_tokenizer.h"
+
+/****************************************************************
+* Description: 특이한 어휘에 대한 ID/토큰 변환 검사 (nemo_edge_vocab_check)
+*              ID 간격, 같은 ID를 쓰는 여러 토큰, 어휘와 같은 문자열의 특수 토큰,
+*              음수 ID와 ID 테이블 상한 이상의 ID를 섞은 WordPiece 어휘를 시드별로 만들고
+*              convert_ids_to_tokens, convert_tokens_to_ids 결과를 단순한 기준 모델과 비교
+*              모든 Trie 엔진과 컴파일된 이미지 경로의 encode 결과가 서로 같은지도 확인
+*
+*              사용법: nemo_edge_vocab_check [--seeds N] [--first S]
+****************************************************************/
+
+namespace {
+
+// 어휘 항목 하나 (loadTokenizer가 읽는 순서: 기본 어휘, 특수 added_tokens, 시작/종료/UNK)
+struct VocabEntry {
+    std::string token;
+    int id;
+    bool special;
+};
+
+// 시드 하나로 만든 tokenizer.json과 로더가 보게 될 항목 순서
+struct EdgeVocab {
+    std::string json;
+    std::vector<VocabEntry> entries;
+    std::vector<std::string> probes; // 변환을 확인할 토큰
+    int maxId;
+    int unkId;
+};
+
+const char* const ALPHABET[] = { "a", "b", "c", "\xEA\xB0\x80" }; // 마지막은 '가' (여러 바이트 문자)
+const int ID_TABLE_CAP = 1 << 20;                                   // 작은 어휘의 ID 테이블 상한
+
+std::string randomWord(std::mt19937& rng, int maxLength) {
+    std::string word;
+    const int length = 1 + static_cast<int>(rng() % maxLength);
+    for (int i = 0; i < length; ++i) word += ALPHABET[rng() % 4];
+    return word;
+}
+
+EdgeVocab makeVocab(unsigned seed) {
+    std::mt19937 rng(seed);
+    EdgeVocab vocab;
+    std::vector<std::pair<std::string, int>> base = { { "[PAD]", 0 }, { "[UNK]", 1 }, { "[CLS]", 2 }, { "[SEP]", 3 } };
+    int nextId = 4;
+    const int words = 5 + static_cast<int>(rng() % 56);
+    for (int i = 0; i < words; ++i) {
+        std::string word = randomWord(rng, 4);
+        if (rng() % 10 < 3) word = "##" + word;
+        const int gaps[] = { 1, 1, 1, 2, 7 };
+        nextId += gaps[rng() % 5];
+        int id = nextId;
+        const unsigned kind = rng() % 20;
+        if (kind < 2) id = static_cast<int>(rng() % (nextId + 1)); // 다른 토큰과 같은 ID
+        else if (kind == 2) id = -2 - static_cast<int>(rng() % 3); // 음수 ID
+        else if (kind == 3) id = ID_TABLE_CAP + static_cast<int>(rng() % 1000); // ID 테이블 상한 이상
+        bool duplicate = false;
+        for (const auto& item : base) duplicate = duplicate || item.first == word;
+        if (!duplicate) base.push_back(std::make_pair(word, id));
+    }
+    for (const char* letter : ALPHABET) {
+        bool present = false;
+        for (const auto& item : base) present = present || item.first == letter;
+        if (!present) base.push_back(std::make_pair(std::string(letter), ++nextId));
+    }
+
+    // added_tokens: 기본 특수 토큰 4개 + 기존 ID의 다른 문자열, 새 ID, 어휘와 같은 문자열, 특수 토큰이 아닌 토큰
+    std::vector<VocabEntry> added;
+    for (int i = 0; i < 4; ++i) added.push_back({ base[i].first, base[i].second, true });
+    const int extra = static_cast<int>(rng() % 5);
+    for (int i = 0; i < extra; ++i) {
+        const unsigned kind = rng() % 10;
+        const std::string digit = std::to_string(rng() % 10);
+        if (kind < 3) added.push_back({ "<x" + digit + ">", static_cast<int>(rng() % (nextId + 1)), true });
+        else if (kind < 6) added.push_back({ "<n" + digit + ">", nextId + 1 + static_cast<int>(rng() % 50), true });
+        else if (kind < 8) added.push_back({ base[rng() % base.size()].first, nextId + 1 + static_cast<int>(rng() % 50), true });
+        else added.push_back({ "zz", static_cast<int>(rng() % (nextId + 1)), false });
+    }
+
+    std::ostringstream json;
+    json << "{\"added_tokens\":[";
+    for (size_t i = 0; i < added.size(); ++i) {
+        json << (i ? "," : "") << "{\"id\":" << added[i].id << ",\"content\":\"" << added[i].token
+             << "\",\"special\":" << (added[i].special ? "true" : "false") << "}";
+    }
+    json << "],\"decoder\":{\"type\":\"WordPiece\",\"prefix\":\"##\"},"
+         << "\"model\":{\"type\":\"WordPiece\",\"unk_token\":\"[UNK]\",\"vocab\":{";
+    for (size_t i = 0; i < base.size(); ++i) {
+        json << (i ? "," : "") << "\"" << base[i].first << "\":" << base[i].second;
+    }
+    json << "}}}";
+    vocab.json = json.str();
+
+    vocab.maxId = nextId + 60;
+    for (const auto& item : base) {
+        vocab.entries.push_back({ item.first, item.second, false });
+        vocab.probes.push_back(item.first);
+    }
+    for (const VocabEntry& e : added) {
+        if (e.special) vocab.entries.push_back(e);
+        vocab.probes.push_back(e.token);
+    }
+    // 시작/종료/UNK 토큰의 ID는 added_tokens에서 같은 문자열의 마지막 항목
+    for (const char* name : { "[CLS]", "[SEP]", "[UNK]" }) {
+        int id = -1;
+        for (const VocabEntry& e : added) if (e.token == name) id = e.id;
+        vocab.entries.push_back({ name, id, true });
+    }
+    vocab.unkId = vocab.entries.back().id;
+    for (int d = 0; d < 10; ++d) {
+        vocab.probes.push_back("<x" + std::to_string(d) + ">");
+        vocab.probes.push_back("<n" + std::to_string(d) + ">");
+    }
+    vocab.probes.push_back("");
+    vocab.probes.push_back("nope");
+    return vocab;
+}
+
+/**
+ * 기준 모델: 항목을 읽은 순서대로 적용합니다.
+ * ID -> 토큰은 기본 어휘끼리 같은 ID면 바이트 사전순으로 나중인 토큰, 특수 토큰은 ID가 이미 있으면 표시만 하고
+ * 없으면 등록합니다. 음수 ID와 상한 이상의 ID는 ID -> 토큰 변환에 넣지 않습니다.
+ * 토큰 -> ID는 표시만 한 항목을 제외한 마지막 항목의 ID입니다.
+ */
+struct ReferenceModel {
+    std::map<int, std::pair<std::string, bool>> byId;
+    std::map<std::string, int> byToken;
+
+    explicit ReferenceModel(const std::vector<VocabEntry>& entries) {
+        for (const VocabEntry& e : entries) {
+            const bool indexed = e.id >= 0 && e.id < ID_TABLE_CAP;
+            auto found = indexed ? byId.find(e.id) : byId.end();
+            if (e.special && found != byId.end()) {
+                found->second.second = true;
+                continue;
+            }
+            if (indexed && (e.special || found == byId.end() || found->second.first < e.token)) {
+                byId[e.id] = std::make_pair(e.token, e.special);
+            }
+            byToken[e.token] = e.id;
+        }
+    }
+
+    std::vector<std::string> idsToTokens(const std::vector<int>& ids, bool skipSpecial, const std::string& unk) const {
+        std::vector<std::string> tokens;
+        for (int id : ids) {
+            auto found = byId.find(id);
+            if (found == byId.end()) tokens.push_back(unk);
+            else if (!(skipSpecial && found->second.second)) tokens.push_back(found->second.first);
+        }
+        return tokens;
+    }
+
+    std::vector<int> tokensToIds(const std::vector<std::string>& tokens, int unkId) const {
+        std::vector<int> ids;
+        for (const std::string& token : tokens) {
+            auto found = byToken.find(token);
+            ids.push_back(found == byToken.end() ? unkId : found->second);
+        }
+        return ids;
+    }
+};
+
+const TrieEngine ENGINES[] = { TrieEngine::DoubleArray, TrieEngine::Frozen, TrieEngine::Dense, TrieEngine::Radix };
+
+// 시드 하나를 검사하고 불일치 수를 반환
+int checkSeed(unsigned seed, const std::string& imagePath) {
+    const EdgeVocab vocab = makeVocab(seed);
+    const ReferenceModel reference(vocab.entries);
+    std::vector<int> ids;
+    for (int id = -5; id <= vocab.maxId; ++id) ids.push_back(id);
+    ids.push_back(ID_TABLE_CAP);
+    ids.push_back(ID_TABLE_CAP + 999);
+
+    std::mt19937 rng(seed);
+    std::string text;
+    for (int i = 0; i < 40; ++i) text += randomWord(rng, 6) + (rng() % 5 ? " " : "[SEP]");
+
+    int mismatches = 0;
+    std::vector<int> firstEncoding;
+    for (const TrieEngine engine : ENGINES) {
+        for (int path = 0; path < 2; ++path) {
+            NemoTokenizer tokenizer;
+            tokenizer.setTrieEngine(engine);
+            if (path == 0) {
+                if (!tokenizer.loadFromBuffer(vocab.json.data(), vocab.json.size())) return 1;
+            } else {
+                NemoTokenizer builder;
+                builder.setTrieEngine(engine);
+                if (!builder.loadFromBuffer(vocab.json.data(), vocab.json.size()) || !builder.saveCompiled(imagePath)
+                    || !tokenizer.loadCompiled(imagePath)) return 1;
+            }
+            const char* where = path == 0 ? "json" : "compiled";
+
+            for (int skip = 0; skip < 2; ++skip) {
+                if (tokenizer.convert_ids_to_tokens(ids, skip != 0) != reference.idsToTokens(ids, skip != 0, "[UNK]")) {
+                    std::printf("seed %u %s: convert_ids_to_tokens(skip_special_tokens=%d) 불일치\n", seed, where, skip);
+                    ++mismatches;
+                }
+            }
+            if (tokenizer.convert_tokens_to_ids(vocab.probes, false) != reference.tokensToIds(vocab.probes, vocab.unkId)) {
+                std::printf("seed %u %s: convert_tokens_to_ids 불일치\n", seed, where);
+                ++mismatches;
+            }
+
+            const std::vector<int> encoding = tokenizer.encode(text);
+            if (firstEncoding.empty()) firstEncoding = encoding;
+            else if (encoding != firstEncoding) {
+                std::printf("seed %u %s: encode 결과가 엔진/로드 경로마다 다름\n", seed, where);
+                ++mismatches;
+            }
+        }
+    }
+    return mismatches;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    unsigned seeds = 200;
+    unsigned first = 0;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--seeds" && i + 1 < argc) seeds = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        else if (arg == "--first" && i + 1 < argc) first = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        else {
+            std::fprintf(stderr, "usage: nemo_edge_vocab_check [--seeds N] [--first S]\n");
+            return 2;
+        }
+    }
+
+    const std::string imagePath = CompiledSharedDirectory() + "/nemo_edge_vocab_check_" + std::to_string(CompiledProcessId()) + ".bin";
+    int failures = 0;
+    for (unsigned seed = first; seed < first + seeds; ++seed) {
+        failures += checkSeed(seed, imagePath);
+    }
+    std::remove(imagePath.c_str());
+    std::printf("%u개 어휘, 불일치 %d건\n", seeds, failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,384 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "nemo_tokenizer.h"
+
+#if defined(_WIN32)
+#include <psapi.h>
+#ifdef _MSC_VER
+#pragma comment(lib, "psapi.lib")
+#endif
+#define popen _popen
+#define pclose _pclose
+#else
+#include <sys/resource.h>
+#endif
+
+/****************************************************************
+* Description: 로드 경로별 시작 시간/메모리 벤치마크 (nemo_load_benchmark)
+*              합성 어휘(WordPiece/SentencePiece 30k, 128k, 256k)와 인자로 준
+*              실제 tokenizer.json을 모든 로드 경로로 읽고
+*              로드 시간, 첫 디코드 시간(지연 생성 테이블), RSS, 최대 RSS,
+*              구조별 바이트 수(memoryUsage)를 출력
+*              최대 RSS가 섞이지 않도록 측정마다 자기 자신을 자식 프로세스로 실행
+*
+*              사용법: nemo_load_benchmark [--repeat N] [--engine double_array|frozen|dense|radix]
+*                                          [--sizes 30000,128000,256000] [--csv] [tokenizer.json ...]
+****************************************************************/
+
+namespace {
+
+// 측정하는 로드 경로
+const char* const LOAD_PATHS[] = {
+    "json_file",     // loadTokenizer: 파일 스트리밍 파싱
+    "json_buffer",   // loadFromBuffer: 메모리의 JSON 스트리밍 파싱
+    "compiled_mmap", // loadCompiled: 컴파일된 이미지 매핑
+    "shared_attach", // loadShared: 다른 프로세스가 만든 공유 이미지에 연결
+};
+
+// 측정 결과 한 건
+struct Sample {
+    double loadMs;
+    double firstDecodeMs;
+    size_t rssAfterLoad;
+    size_t rssAfterDecode;
+    size_t peakRss;
+    std::vector<std::pair<std::string, size_t>> structures;
+};
+
+size_t currentRss() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    return GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)) ? counters.WorkingSetSize : 0;
+#elif defined(__linux__)
+    FILE* fp = std::fopen("/proc/self/statm", "r");
+    if (!fp) return 0;
+    long pages = 0, resident = 0;
+    const int n = std::fscanf(fp, "%ld %ld", &pages, &resident);
+    std::fclose(fp);
+    return n == 2 ? static_cast<size_t>(resident) * static_cast<size_t>(sysconf(_SC_PAGESIZE)) : 0;
+#else
+    return 0;
+#endif
+}
+
+size_t peakRss() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    return GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)) ? counters.PeakWorkingSetSize : 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#if defined(__APPLE__)
+    return static_cast<size_t>(usage.ru_maxrss);        // 바이트
+#else
+    return static_cast<size_t>(usage.ru_maxrss) * 1024; // KB
+#endif
+#endif
+}
+
+double elapsedMs(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+}
+
+bool parseEngine(const std::string& name, TrieEngine& engine) {
+    if (name == "double_array") engine = TrieEngine::DoubleArray;
+    else if (name == "frozen") engine = TrieEngine::Frozen;
+    else if (name == "dense") engine = TrieEngine::Dense;
+    else if (name == "radix") engine = TrieEngine::Radix;
+    else return false;
+    return true;
+}
+
+bool readFile(const std::string& path, std::string& data) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+    std::ostringstream buffer;
+    buffer << file.rdbuf();
+    data = buffer.str();
+    return true;
+}
+
+std::string quote(const std::string& s) {
+    return "\"" + s + "\"";
+}
+
+void appendJsonString(std::string& out, const std::string& s) {
+    out += '"';
+    for (char c : s) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    out += '"';
+}
+
+void appendUtf8(std::string& out, uint32_t code) {
+    out += static_cast<char>(0xE0 | (code >> 12));
+    out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+    out += static_cast<char>(0x80 | (code & 0x3F));
+}
+
+// 영문/한글/숫자가 섞인 임의 단어
+std::string randomWord(std::mt19937& rng) {
+    std::string word;
+    const int kind = static_cast<int>(rng() % 100);
+    if (kind < 50) {
+        for (int n = 1 + static_cast<int>(rng() % 9); n > 0; --n) word += static_cast<char>('a' + rng() % 26);
+    } else if (kind < 85) {
+        for (int n = 1 + static_cast<int>(rng() % 4); n > 0; --n) appendUtf8(word, 0xAC00 + static_cast<uint32_t>(rng() % 400));
+    } else {
+        for (int n = 1 + static_cast<int>(rng() % 4); n > 0; --n) word += static_cast<char>('0' + rng() % 10);
+    }
+    return word;
+}
+
+/**
+ * 합성 tokenizer.json을 만듭니다.
+ * @param sentencePiece true면 Metaspace(▁) 어휘, false면 WordPiece(##) 어휘
+ * @param size 어휘 수
+ * @return JSON 텍스트
+ */
+std::string syntheticTokenizer(bool sentencePiece, size_t size) {
+    std::mt19937 rng(static_cast<uint32_t>(size) * 2 + (sentencePiece ? 1 : 0));
+    const std::string marker = sentencePiece ? "\xE2\x96\x81" : "##";
+    const std::vector<std::string> specials = sentencePiece
+        ? std::vector<std::string>{ "<pad>", "<unk>", "<s>", "</s>" }
+        : std::vector<std::string>{ "[PAD]", "[UNK]", "[CLS]", "[SEP]", "[MASK]" };
+
+    std::unordered_map<std::string, int> seen;
+    std::vector<std::string> tokens;
+    auto add = [&](const std::string& token) {
+        if (seen.emplace(token, static_cast<int>(tokens.size())).second) tokens.push_back(token);
+    };
+    for (const auto& s : specials) add(s);
+    for (const char* c = "abcdefghijklmnopqrstuvwxyz0123456789.,!?"; *c; ++c) {
+        add(std::string(1, *c));
+        add(marker + *c);
+    }
+    while (tokens.size() < size) {
+        const std::string word = randomWord(rng);
+        add((rng() % 100 < 45) ? marker + word : word);
+    }
+
+    std::string json = "{\"version\":\"1.0\",\"added_tokens\":[";
+    for (size_t i = 0; i < specials.size(); ++i) {
+        if (i) json += ',';
+        json += "{\"id\":" + std::to_string(i) + ",\"content\":";
+        appendJsonString(json, specials[i]);
+        json += ",\"special\":true}";
+    }
+    json += sentencePiece ? "],\"decoder\":{\"type\":\"Metaspace\",\"replacement\":\"\xE2\x96\x81\"},"
+                            "\"model\":{\"type\":\"Unigram\",\"unk_token\":\"<unk>\",\"vocab\":{"
+                          : "],\"decoder\":{\"type\":\"WordPiece\",\"prefix\":\"##\"},"
+                            "\"model\":{\"type\":\"WordPiece\",\"unk_token\":\"[UNK]\",\"vocab\":{";
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        if (i) json += ',';
+        appendJsonString(json, tokens[i]);
+        json += ':' + std::to_string(i);
+    }
+    json += "}}}";
+    return json;
+}
+
+/**
+ * 자식 프로세스: 로드 경로 하나를 측정하여 한 줄로 출력합니다.
+ * 형식: load_ms first_decode_ms rss_after_load rss_after_decode peak_rss 이름=바이트...
+ */
+int runChild(const std::string& path, const std::string& file, const std::string& extra, TrieEngine engine) {
+    NemoTokenizer tokenizer;
+    tokenizer.setTrieEngine(engine);
+    std::string buffer;
+    if (path == "json_buffer" && !readFile(file, buffer)) return 1;
+
+    const auto loadStart = std::chrono::steady_clock::now();
+    bool ok = true;
+    if (path == "json_file") tokenizer.loadTokenizer(file);
+    else if (path == "json_buffer") ok = tokenizer.loadFromBuffer(buffer.data(), buffer.size());
+    else if (path == "compiled_mmap") ok = tokenizer.loadCompiled(extra);
+    else if (path == "shared_attach") ok = tokenizer.loadShared(file, extra) == SharedLoad::Shared;
+    else ok = false;
+    const double loadMs = elapsedMs(loadStart);
+    if (!ok) return 1;
+    std::string().swap(buffer);
+    const size_t rssAfterLoad = currentRss();
+
+    // 디코드용 테이블은 처음 사용할 때 만들어지므로 따로 측정
+    const auto decodeStart = std::chrono::steady_clock::now();
+    const std::string text = tokenizer.decode(std::vector<int>{ 0, 1, 2, 3 }, false);
+    const double firstDecodeMs = elapsedMs(decodeStart);
+    const size_t rssAfterDecode = currentRss();
+
+    // 최대 RSS는 커널이 늦게 갱신할 수 있어 마지막으로 잰 RSS보다 작지 않게 보정
+    const size_t peak = std::max(peakRss(), std::max(rssAfterLoad, rssAfterDecode));
+    std::printf("%.3f %.3f %zu %zu %zu", loadMs, firstDecodeMs, rssAfterLoad, rssAfterDecode, peak);
+    for (const auto& usage : tokenizer.memoryUsage()) std::printf(" %s=%zu", usage.first.c_str(), usage.second);
+    std::printf(" decoded=%zu\n", text.size());
+    return 0;
+}
+
+// 자식 프로세스를 실행하여 결과 한 줄을 읽습니다.
+bool runSample(const std::string& self, const std::string& path, const std::string& file,
+               const std::string& extra, const std::string& engine, Sample& sample) {
+    const std::string command = quote(self) + " --child " + path + " " + quote(file) + " " + quote(extra) + " " + engine;
+    FILE* pipe = popen(command.c_str(), "r");
+    if (!pipe) return false;
+    std::string line;
+    char chunk[4096];
+    while (std::fgets(chunk, sizeof(chunk), pipe)) line += chunk;
+    if (pclose(pipe) != 0) return false;
+
+    std::istringstream in(line);
+    if (!(in >> sample.loadMs >> sample.firstDecodeMs >> sample.rssAfterLoad >> sample.rssAfterDecode >> sample.peakRss)) return false;
+    sample.structures.clear();
+    std::string field;
+    while (in >> field) {
+        const size_t eq = field.find('=');
+        if (eq == std::string::npos || field.compare(0, eq, "decoded") == 0) continue;
+        sample.structures.emplace_back(field.substr(0, eq), std::strtoull(field.c_str() + eq + 1, nullptr, 10));
+    }
+    return true;
+}
+
+double megabytes(size_t bytes) {
+    return static_cast<double>(bytes) / (1024.0 * 1024.0);
+}
+
+void printSample(const std::string& vocab, const std::string& path, const Sample& s, bool csv) {
+    static bool csvHeader = false;
+    if (csv && !csvHeader) {
+        // 구조 열은 memoryUsage 항목 순서 그대로
+        std::printf("vocab,path,load_ms,first_decode_ms,rss_after_load,rss_after_decode,peak_rss");
+        for (const auto& usage : s.structures) std::printf(",%s", usage.first.c_str());
+        std::printf("\n");
+        csvHeader = true;
+    }
+    std::string structures;
+    for (const auto& usage : s.structures) {
+        char item[96];
+        if (csv) std::snprintf(item, sizeof(item), ",%zu", usage.second);
+        else std::snprintf(item, sizeof(item), " %s=%.2f", usage.first.c_str(), megabytes(usage.second));
+        structures += item;
+    }
+    if (csv) {
+        std::printf("%s,%s,%.3f,%.3f,%zu,%zu,%zu%s\n", vocab.c_str(), path.c_str(), s.loadMs, s.firstDecodeMs,
+                    s.rssAfterLoad, s.rssAfterDecode, s.peakRss, structures.c_str());
+    } else {
+        std::printf("%-24s %-14s %9.1f %9.1f %9.1f %9.1f %9.1f  %s\n", vocab.c_str(), path.c_str(), s.loadMs, s.firstDecodeMs,
+                    megabytes(s.rssAfterLoad), megabytes(s.rssAfterDecode), megabytes(s.peakRss), structures.c_str() + 1);
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc == 6 && std::strcmp(argv[1], "--child") == 0) {
+        TrieEngine engine;
+        if (!parseEngine(argv[5], engine)) return 2;
+        return runChild(argv[2], argv[3], argv[4], engine);
+    }
+
+    int repeat = 3;
+    bool csv = false;
+    std::string engineName = "double_array";
+    std::vector<size_t> sizes = { 30000, 128000, 256000 };
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--repeat" && i + 1 < argc) repeat = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--engine" && i + 1 < argc) engineName = argv[++i];
+        else if (arg == "--csv") csv = true;
+        else if (arg == "--sizes" && i + 1 < argc) {
+            sizes.clear();
+            std::istringstream list(argv[++i]);
+            std::string item;
+            while (std::getline(list, item, ',')) if (!item.empty()) sizes.push_back(std::strtoull(item.c_str(), nullptr, 10));
+        } else if (!arg.empty() && arg[0] == '-') {
+            std::fprintf(stderr, "usage: nemo_load_benchmark [--repeat N] [--engine double_array|frozen|dense|radix] "
+                                 "[--sizes 30000,128000,256000] [--csv] [tokenizer.json ...]\n");
+            return 2;
+        } else {
+            files.push_back(arg);
+        }
+    }
+    TrieEngine engine;
+    if (!parseEngine(engineName, engine)) {
+        std::fprintf(stderr, "Error: 알 수 없는 Trie 엔진: %s\n", engineName.c_str());
+        return 2;
+    }
+
+    // 작업 파일은 공유 이미지와 같은 임시 디렉터리에 둠
+    const std::string workDir = CompiledSharedDirectory();
+    const std::string prefix = workDir + "/nemo_load_benchmark_" + std::to_string(CompiledProcessId());
+    std::vector<std::pair<std::string, std::string>> inputs; // (이름, 경로)
+    std::vector<std::string> temporary;
+    for (size_t size : sizes) {
+        for (int sp = 0; sp < 2; ++sp) {
+            const std::string name = std::string(sp ? "synthetic_sp_" : "synthetic_wp_") + std::to_string(size / 1000) + "k";
+            const std::string path = prefix + "_" + name + ".json";
+            std::ofstream out(path, std::ios::binary);
+            out << syntheticTokenizer(sp != 0, size);
+            if (!out) {
+                std::fprintf(stderr, "Error: 합성 어휘를 쓸 수 없습니다: %s\n", path.c_str());
+                return 1;
+            }
+            inputs.emplace_back(name, path);
+            temporary.push_back(path);
+        }
+    }
+    for (const auto& file : files) {
+        const size_t slash = file.find_last_of("/\\");
+        inputs.emplace_back(slash == std::string::npos ? file : file.substr(slash + 1), file);
+    }
+
+    if (!csv) {
+        std::printf("engine=%s repeat=%d (best load time of each path, MB)\n", engineName.c_str(), repeat);
+        std::printf("%-24s %-14s %9s %9s %9s %9s %9s  %s\n", "vocab", "path", "load_ms", "decode_ms",
+                    "rss_load", "rss_dec", "peak_rss", "structures");
+    }
+
+    int failures = 0;
+    for (const auto& input : inputs) {
+        // 컴파일된 이미지와 공유 이미지는 측정 전에 만들어 둠 (측정은 연결 비용만)
+        const std::string compiled = prefix + "_" + input.first + ".bin";
+        const std::string sharedDir = workDir;
+        std::string sharedImage;
+        {
+            NemoTokenizer builder;
+            builder.setTrieEngine(engine);
+            builder.loadTokenizer(input.second);
+            if (!builder.saveCompiled(compiled)) ++failures;
+            NemoTokenizer shared;
+            shared.setTrieEngine(engine);
+            if (shared.loadShared(input.second, sharedDir) != SharedLoad::Shared) ++failures;
+            sharedImage = shared.sharedImagePath(input.second, sharedDir);
+        }
+
+        for (const char* path : LOAD_PATHS) {
+            const std::string extra = (std::strcmp(path, "compiled_mmap") == 0) ? compiled : sharedDir;
+            Sample best;
+            bool have = false;
+            for (int r = 0; r < repeat; ++r) {
+                Sample sample;
+                if (!runSample(argv[0], path, input.second, extra, engineName, sample)) continue;
+                if (!have || sample.loadMs < best.loadMs) best = sample;
+                have = true;
+            }
+            if (have) printSample(input.first, path, best, csv);
+            else {
+                std::fprintf(stderr, "Error: 측정 실패: %s %s\n", input.first.c_str(), path);
+                ++failures;
+            }
+        }
+        std::remove(compiled.c_str());
+        std::remove(sharedImage.c_str());
+    }
+
+    for (const auto& path : temporary) std::remove(path.c_str());
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,108 @@
+"""
+Python thread scaling benchmark for NemoTokenizer
+
+The C++ entry points release the GIL while they tokenize, so several Python
+threads sharing one tokenizer should encode in parallel. This script runs the
+same workload with 1, 2, 4, ... threads and reports throughput and speedup
+over one thread.
+
+Usage:
+    python benchmarks/thread_benchmark.py tokenizer.json [--threads 1,2,4,8]
+        [--method encode|encode_np|encode_into|tokenize|batch_encode]
+        [--docs 20000] [--words 200] [--batch-size 64] [--repeat 3] [--engine double_array]
+"""
+
+import argparse
+import os
+import random
+import sys
+import threading
+import time
+
+from nemo_tokenizer import NemoTokenizer
+
+
+WORDS = ["the", "tokenizer", "performance", "of", "hello", "world", "자연어", "처리는",
+         "컴퓨터가", "언어를", "이해하고", "12345", "benchmark", "threads", "scaling", "!", ","]
+
+
+def make_documents(count, words, seed=0):
+    """Build count synthetic documents of about words words each"""
+    rng = random.Random(seed)
+    return [" ".join(rng.choice(WORDS) for _ in range(words)) for _ in range(count)]
+
+
+def make_worker(tokenizer, method, batch_size):
+    """Return a function that encodes one slice of documents with the chosen method"""
+    if method == "encode":
+        return lambda docs: [tokenizer.encode(d) for d in docs]
+    if method == "encode_np":
+        return lambda docs: [tokenizer.encode_np(d) for d in docs]
+    if method == "encode_into":
+        import numpy as np
+
+        def run(docs):
+            out = np.empty(1 << 16, dtype=np.int32)  # one reused buffer per thread
+            for d in docs:
+                tokenizer.encode_into(d, out)
+        return run
+    if method == "tokenize":
+        return lambda docs: [tokenizer.tokenize(d) for d in docs]
+    if method == "batch_encode":
+        return lambda docs: [tokenizer.batch_encode(docs[i:i + batch_size]) for i in range(0, len(docs), batch_size)]
+    raise ValueError(f"Unknown method: {method}")
+
+
+def run_threads(work, documents, threads):
+    """Split documents over threads, run them together and return elapsed seconds"""
+    slices = [documents[i::threads] for i in range(threads)]
+    start = threading.Barrier(threads + 1)
+
+    def body(docs):
+        start.wait()
+        work(docs)
+
+    workers = [threading.Thread(target=body, args=(docs,)) for docs in slices]
+    for w in workers:
+        w.start()
+    start.wait()
+    began = time.perf_counter()
+    for w in workers:
+        w.join()
+    return time.perf_counter() - began
+
+
+def main():
+    parser = argparse.ArgumentParser(description="NemoTokenizer Python thread scaling benchmark")
+    parser.add_argument("tokenizer_file", help="Path to a tokenizer.json file")
+    parser.add_argument("--threads", default="1,2,4,8", help="Comma-separated thread counts")
+    parser.add_argument("--method", default="encode",
+                        choices=["encode", "encode_np", "encode_into", "tokenize", "batch_encode"])
+    parser.add_argument("--docs", type=int, default=20000, help="Documents per run")
+    parser.add_argument("--words", type=int, default=200, help="Words per document")
+    parser.add_argument("--batch-size", type=int, default=64, help="Documents per call for batch_encode")
+    parser.add_argument("--repeat", type=int, default=3, help="Runs per thread count (best is reported)")
+    parser.add_argument("--engine", default="double_array", help="Trie engine")
+    args = parser.parse_args()
+
+    thread_counts = [int(t) for t in args.threads.split(",") if t]
+    tokenizer = NemoTokenizer(args.tokenizer_file, trie_engine=args.engine)
+    documents = make_documents(args.docs, args.words)
+    work = make_worker(tokenizer, args.method, args.batch_size)
+    total_tokens = sum(len(tokenizer.encode(d)) for d in documents)
+    work(documents[:100])  # warm up thread-local buffers and lazily built tables
+
+    print(f"method={args.method} docs={args.docs} tokens={total_tokens} cpus={os.cpu_count()} "
+          f"python={sys.version.split()[0]}")
+    print(f"{'threads':>8} {'seconds':>9} {'docs/s':>11} {'Mtokens/s':>10} {'speedup':>8}")
+    baseline = None
+    for threads in thread_counts:
+        seconds = min(run_threads(work, documents, threads) for _ in range(max(1, args.repeat)))
+        if baseline is None:
+            baseline = seconds  # speedup is relative to the first thread count
+        print(f"{threads:>8} {seconds:>9.3f} {args.docs / seconds:>11.0f} "
+              f"{total_tokens / seconds / 1e6:>10.2f} {baseline / seconds:>8.2f}")
+
+
+if __name__ == "__main__":
+    main()
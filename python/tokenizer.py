@@ -5,15 +5,15 @@ Python interface for NemoTokenizer
 import os
 import sys
 import importlib.util
-from typing import List, Union, Dict, Any, Optional
+from typing import List, Union, Dict, Any, Optional, Tuple
 
 
 # Attempt to load the C++ extension module
 def _load_extension():
     try:
         # Try standard import first
-        from .nemo_tokenizer_core import NemoTokenizerCore
-        return NemoTokenizerCore
+        from . import nemo_tokenizer_core
+        return nemo_tokenizer_core
     except ImportError:
         # Try to manually locate the module
         try:
@@ -28,7 +28,7 @@ def _load_extension():
                     if spec:
                         module = importlib.util.module_from_spec(spec)
                         spec.loader.exec_module(module)
-                        return module.NemoTokenizerCore
+                        return module
             
             # Module not found
             raise ImportError(
@@ -47,7 +47,10 @@ def _load_extension():
 
 
 # Attempt to load the C++ extension module
-NemoTokenizerCore = _load_extension()
+_core = _load_extension()
+NemoTokenizerCore = _core.NemoTokenizerCore
+TrieEngine = _core.TrieEngine
+SharedLoad = _core.SharedLoad
 
 
 class NemoTokenizer:
@@ -57,23 +60,40 @@ class NemoTokenizer:
     Provides a Python interface wrapping the C++ implementation.
     """
     
-    def __init__(self, tokenizer_file: Optional[str] = None):
+    def __init__(self, tokenizer_file: Optional[str] = None, trie_engine: str = "double_array",
+                 interleaved: bool = False, shared: bool = False, decode_tables: bool = True):
         """
         Initialize the NemoTokenizer
         
         Args:
             tokenizer_file: Path to the tokenizer JSON file (optional)
+            trie_engine: Search trie layout ("double_array", "frozen", "dense" or "radix")
+            interleaved: Match several words in lock-step to overlap trie cache misses
+            shared: Load through load_shared so worker processes share one copy of the model
+            decode_tables: Keep what decode/convert_* need (built on first use); False for encode-only workers
         """
         self._tokenizer = NemoTokenizerCore()
+        # Settings live on the wrapper and are applied to the fresh core of the next load;
+        # the loaded core is never modified while other threads may be using it
+        self._trie_engine = TrieEngine.DOUBLE_ARRAY
+        self._interleaved = False
+        self._decode_tables = True
+        self.set_trie_engine(trie_engine)
+        self.set_interleaved_matching(interleaved)
+        self.set_decode_tables(decode_tables)
         
         if tokenizer_file is not None:
             if not os.path.exists(tokenizer_file):
                 raise FileNotFoundError(f"Tokenizer file not found: {tokenizer_file}")
-            self.load_tokenizer(tokenizer_file)
+            if shared:
+                self.load_shared(tokenizer_file)
+            else:
+                self.load_tokenizer(tokenizer_file)
     
     def load_tokenizer(self, tokenizer_file: str) -> None:
         """
-        Load tokenizer JSON file
+        Load tokenizer JSON file. On failure the current model stays in use
+        and ValueError is raised (the process is not terminated).
         
         Args:
             tokenizer_file: Path to the tokenizer JSON file
@@ -81,7 +101,155 @@ class NemoTokenizer:
         if not os.path.exists(tokenizer_file):
             raise FileNotFoundError(f"Tokenizer file not found: {tokenizer_file}")
         
-        self._tokenizer.loadTokenizer(tokenizer_file)
+        core = self._new_core()
+        if not core.tryLoadTokenizer(tokenizer_file):
+            raise ValueError(f"Invalid tokenizer file: {tokenizer_file}")
+        self._tokenizer = core
+    
+    def load_from_buffer(self, data: Union[bytes, bytearray, memoryview]) -> None:
+        """
+        Load a tokenizer from the bytes of a tokenizer.json file (e.g. fetched from
+        a model registry).
+        
+        Like every load_* method, the new model is built on a separate core and
+        swapped in with one reference assignment, so calls already running on
+        other threads finish on the old model and later calls use the new one.
+        
+        Args:
+            data: Contents of a tokenizer.json file
+        """
+        core = self._new_core()
+        if not core.loadFromBuffer(data):
+            raise ValueError("Invalid tokenizer.json buffer")
+        self._tokenizer = core
+    
+    def save_compiled(self, compiled_file: str) -> None:
+        """
+        Save the loaded tokenizer (built trie, id tables, special tokens) as a
+        versioned, checksummed flat file that load_compiled can memory-map
+        
+        Args:
+            compiled_file: Output path
+        """
+        if not self._tokenizer.saveCompiled(compiled_file):
+            raise RuntimeError(f"Failed to save compiled tokenizer: {compiled_file}")
+    
+    def load_compiled(self, compiled_file: str) -> None:
+        """
+        Load a file written by save_compiled. The trie is used directly from the
+        memory-mapped file, and the trie engine switches to the one it was saved with.
+        
+        Args:
+            compiled_file: Path to the compiled tokenizer file
+        """
+        if not os.path.exists(compiled_file):
+            raise FileNotFoundError(f"Compiled tokenizer file not found: {compiled_file}")
+        
+        core = self._new_core()
+        if not core.loadCompiled(compiled_file):
+            raise ValueError(f"Invalid or incompatible compiled tokenizer file: {compiled_file}")
+        self._tokenizer = core
+    
+    def load_shared(self, tokenizer_file: str, directory: Optional[str] = None) -> bool:
+        """
+        Load a tokenizer JSON file so that every process on the machine shares one
+        read-only copy. The first process builds a compiled image under directory
+        (default /dev/shm, or the temp directory) and later processes, e.g. forked or
+        spawned workers, memory-map it instead of building their own tables.
+        
+        Images are never deleted automatically. Each tokenizer.json size/mtime and
+        trie engine gets its own image in RAM-backed storage, so call remove_shared
+        once the image is no longer needed (e.g. before replacing tokenizer.json).
+        On failure the current model stays in use and ValueError is raised.
+        
+        Args:
+            tokenizer_file: Path to the tokenizer JSON file
+            directory: Where to keep the shared compiled image (optional)
+            
+        Returns:
+            True if the shared image is in use, False if a private copy was loaded instead
+        """
+        if not os.path.exists(tokenizer_file):
+            raise FileNotFoundError(f"Tokenizer file not found: {tokenizer_file}")
+        
+        core = self._new_core()
+        result = core.loadShared(tokenizer_file, directory or "")
+        if result == SharedLoad.FAILED:
+            raise ValueError(f"Invalid tokenizer file: {tokenizer_file}")
+        self._tokenizer = core
+        return result == SharedLoad.SHARED
+    
+    def remove_shared(self, tokenizer_file: str, directory: Optional[str] = None) -> bool:
+        """
+        Delete the shared image that load_shared creates for tokenizer_file with the
+        current trie_engine setting. Processes that already mapped it keep working;
+        the next load_shared builds it again.
+        
+        Args:
+            tokenizer_file: Path to the tokenizer JSON file
+            directory: Directory passed to load_shared (optional)
+            
+        Returns:
+            True if an image was deleted
+        """
+        return self._new_core().removeShared(tokenizer_file, directory or "")
+    
+    def _new_core(self):
+        """Create an empty core with the current settings, to load a replacement model into"""
+        core = NemoTokenizerCore()
+        core.setTrieEngine(self._trie_engine)
+        core.setInterleavedMatching(self._interleaved)
+        core.setDecodeTables(self._decode_tables)
+        return core
+    
+    def set_trie_engine(self, trie_engine: str) -> None:
+        """
+        Select the search trie layout. Takes effect on the next load_tokenizer,
+        load_from_buffer or load_shared call; the loaded model keeps its trie.
+        
+        Args:
+            trie_engine: "double_array" (compact base/check arrays),
+                         "frozen" (BFS-ordered node arena),
+                         "dense" (byte-class transition tables, fastest, most memory) or
+                         "radix" (path-compressed edge labels, greedy WordPiece matching)
+        """
+        try:
+            engine = getattr(TrieEngine, trie_engine.upper())
+        except AttributeError:
+            raise ValueError(f"Unknown trie engine: {trie_engine}")
+        self._trie_engine = engine
+    
+    def set_interleaved_matching(self, enable: bool) -> None:
+        """
+        Walk up to 8 words in lock-step with prefetching. Output is unchanged;
+        this helps large vocabularies whose trie does not fit in cache.
+        Takes effect on the next load_* call.
+        
+        Args:
+            enable: Whether to use the interleaved matcher
+        """
+        self._interleaved = bool(enable)
+    
+    def set_decode_tables(self, enable: bool) -> None:
+        """
+        Choose whether decode, convert_ids_to_tokens and convert_tokens_to_ids are
+        available. The id/token tables are built lazily on their first call either
+        way; disabling also drops their source so encode-only workers load faster
+        and use less memory. Takes effect on the next load_tokenizer call.
+        
+        Args:
+            enable: Whether to keep the decode-side tables
+        """
+        self._decode_tables = bool(enable)
+    
+    def memory_usage(self) -> Dict[str, int]:
+        """
+        Report bytes used by the main internal structures
+        
+        Returns:
+            Mapping of structure name to bytes
+        """
+        return dict(self._tokenizer.memory_usage())
     
     def batch_tokenize(self, texts: List[str], add_special_tokens: bool = True) -> List[List[str]]:
         """
@@ -121,7 +289,137 @@ class NemoTokenizer:
             List of token IDs
         """
         return self._tokenizer.encode(text, add_special_tokens)
-    
+
+    def encode_into(self, text: Union[str, bytes], out: Any, add_special_tokens: bool = True) -> int:
+        """
+        Convert text to token IDs written into a preallocated buffer, without
+        allocating or creating Python int objects (e.g. a reused request buffer)
+
+        Args:
+            text: Text to encode (str or UTF-8 bytes)
+            out: Writable contiguous 1-D int32 buffer, e.g. np.empty(n, dtype=np.int32),
+                 array.array('i', ...) or a bytearray whose size is a multiple of 4
+            add_special_tokens: Whether to add special tokens
+
+        Returns:
+            Number of token IDs the text encodes to. Only the first len(out) are
+            written; a larger return value means the buffer was too small and
+            the call can be repeated with a buffer of that size.
+        """
+        return self._tokenizer.encode_into(text, out, add_special_tokens)
+
+    def batch_encode(self, texts: List[Union[str, bytes]], add_special_tokens: bool = True) -> Tuple[memoryview, memoryview]:
+        """
+        Convert multiple texts to token IDs in one flat (CSR) layout, encoded in
+        parallel. The IDs of texts[i] are ids[offsets[i]:offsets[i + 1]].
+
+        Both results are read-only memoryviews over the C++ arrays (no copy);
+        np.asarray() or np.frombuffer() turns them into numpy arrays.
+
+        Args:
+            texts: Texts to encode (str or UTF-8 bytes)
+            add_special_tokens: Whether to add special tokens
+
+        Returns:
+            (ids, offsets): int32 IDs of all texts back to back, and
+            len(texts) + 1 int64 offsets into them
+        """
+        batch = self._tokenizer.batch_encode(texts, add_special_tokens)
+        return memoryview(batch.ids), memoryview(batch.offsets)
+
+    def encode_np(self, text: Union[str, bytes], add_special_tokens: bool = True) -> Any:
+        """
+        Convert text to token IDs as a numpy array. The array takes over the C++
+        result buffer, so no Python list or int objects are created.
+
+        Args:
+            text: Text to encode (str or UTF-8 bytes)
+            add_special_tokens: Whether to add special tokens
+
+        Returns:
+            1-D numpy int32 array of token IDs
+        """
+        return self._tokenizer.encode_np(text, add_special_tokens)
+
+    def batch_encode_np(self, texts: List[Union[str, bytes]], add_special_tokens: bool = True) -> Tuple[Any, Any]:
+        """
+        batch_encode returning numpy arrays that take over the C++ buffers.
+        The IDs of texts[i] are ids[offsets[i]:offsets[i + 1]].
+
+        Args:
+            texts: Texts to encode (str or UTF-8 bytes)
+            add_special_tokens: Whether to add special tokens
+
+        Returns:
+            (ids, offsets): numpy int32 IDs of all texts back to back, and
+            len(texts) + 1 numpy int64 offsets into them
+        """
+        return self._tokenizer.batch_encode_np(texts, add_special_tokens)
+
+    def __call__(self, text: Union[str, List[str]], add_special_tokens: bool = True,
+                 padding: Union[bool, str] = False, truncation: bool = False,
+                 max_length: Optional[int] = None, pad_to_multiple_of: Optional[int] = None,
+                 padding_side: str = "right", return_tensors: Optional[str] = None) -> Dict[str, Any]:
+        """
+        Encode a text or a batch of texts into input_ids, attention_mask and
+        token_type_ids, in the style of Hugging Face tokenizers.
+
+        Truncation and padding are done in C++ while the [batch, length] int32
+        arrays are written. Like Hugging Face, "np" and "pt" return int64, which
+        costs one widening copy per array.
+
+        Args:
+            text: Text or list of texts
+            add_special_tokens: Whether to add special tokens
+            padding: False / "do_not_pad", True / "longest" (pad to the longest text)
+                     or "max_length" (pad to max_length)
+            truncation: Cut texts longer than max_length, keeping the start/end tokens
+            max_length: Maximum length, required for truncation and padding="max_length"
+            pad_to_multiple_of: Round the padded length up to a multiple of this value
+            padding_side: "right" or "left"
+            return_tensors: None (Python lists), "np" (numpy int64) or "pt" (torch int64)
+
+        Returns:
+            Dict with "input_ids", "attention_mask" and "token_type_ids". A single
+            text gives one sequence, or a [1, length] array if return_tensors is set
+        """
+        if padding is True:
+            padding = "longest"
+        elif padding is False:
+            padding = "do_not_pad"
+        if padding not in ("longest", "max_length", "do_not_pad"):
+            raise ValueError(f"Unknown padding strategy: {padding}")
+        if padding_side not in ("right", "left"):
+            raise ValueError(f"Unknown padding side: {padding_side}")
+        if return_tensors not in (None, "np", "pt"):
+            raise ValueError(f"Unsupported return_tensors: {return_tensors}")
+        if (truncation or padding == "max_length") and max_length is None:
+            raise ValueError("max_length is required for truncation and padding='max_length'")
+
+        single = isinstance(text, (str, bytes))
+        texts = [text] if single else text
+        pad = padding != "do_not_pad"
+        arrays = self._tokenizer.batch_encode_padded(
+            texts, add_special_tokens, max_length or 0, bool(truncation), padding == "max_length",
+            pad and padding_side == "left", (pad_to_multiple_of or 0) if pad else 0)
+        lengths = arrays[1].sum(axis=1)
+
+        if return_tensors is None:
+            # Python lists; without padding each row is cut back to its own length
+            rows = [[row[:n] for row, n in zip(array.tolist(), lengths.tolist())] if not pad else array.tolist()
+                    for array in arrays]
+            if single:
+                rows = [r[0] for r in rows]
+        else:
+            if not pad and len(set(lengths.tolist())) > 1:
+                raise ValueError("Texts have different lengths; use padding=True to return tensors")
+            if return_tensors == "pt":
+                import torch
+                rows = [torch.from_numpy(array).long() for array in arrays]
+            else:
+                rows = [array.astype("int64") for array in arrays]
+        return dict(zip(("input_ids", "attention_mask", "token_type_ids"), rows))
+
     def decode(self, ids: List[int], skip_special_tokens: bool = True) -> str:
         """
         Convert token IDs to text
@@ -110,7 +110,7 @@ setup(
     python_requires=">=3.7",
     ext_modules=[CMakeExtension("nemo_tokenizer.nemo_tokenizer_core")],
     cmdclass={"build_ext": CMakeBuild},
-    install_requires=[],
+    install_requires=["numpy"],
     zip_safe=False,
     package_data={
         "nemo_tokenizer": ["*.so", "*.pyd", "*.dll", "*.dylib"],
@@ -1,27 +1,244 @@
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
+#include <pybind11/numpy.h>
 #include "nemo_tokenizer.h"
 
 namespace py = pybind11;
 
+// str/bytes의 UTF-8 내용을 복사 없이 가리킴 (str은 파이썬이 캐시한 UTF-8 표현을 사용)
+static void textView(const py::handle& text, const char*& data, size_t& length) {
+    Py_ssize_t size = 0;
+    if (PyUnicode_Check(text.ptr())) {
+        data = PyUnicode_AsUTF8AndSize(text.ptr(), &size);
+    } else if (PyBytes_Check(text.ptr())) {
+        char* bytes = nullptr;
+        if (PyBytes_AsStringAndSize(text.ptr(), &bytes, &size) == 0) data = bytes;
+        else data = nullptr;
+    } else {
+        throw py::type_error("text must be str or bytes");
+    }
+    if (!data) throw py::error_already_set();
+    length = static_cast<size_t>(size);
+}
+
+// 쓰기 가능한 1차원 연속 int32 버퍼 (numpy int32 배열, array('i'), 4바이트 정렬된 bytearray 등)
+static int32_t* idBuffer(const py::buffer_info& info, size_t& capacity) {
+    if (info.readonly) throw py::value_error("encode_into: the output buffer is read-only");
+    if (info.ndim != 1 || info.strides[0] != info.itemsize) {
+        throw py::value_error("encode_into: a contiguous 1-D buffer is required");
+    }
+    const size_t bytes = static_cast<size_t>(info.size * info.itemsize);
+    const bool int32Items = info.itemsize == 4 && (info.format == "i" || info.format == "l" || info.format == "=i" || info.format == "<i");
+    const bool byteItems = info.itemsize == 1 && (info.format == "B" || info.format == "b" || info.format == "c");
+    if (!int32Items && !(byteItems && bytes % sizeof(int32_t) == 0)) {
+        throw py::value_error("encode_into: an int32 buffer (or a byte buffer whose size is a multiple of 4) is required");
+    }
+    if (reinterpret_cast<uintptr_t>(info.ptr) % alignof(int32_t) != 0) {
+        throw py::value_error("encode_into: the output buffer must be 4-byte aligned");
+    }
+    capacity = bytes / sizeof(int32_t);
+    return static_cast<int32_t*>(info.ptr);
+}
+
+// 설정은 로드 전의 새 코어에만 허용 (로드된 코어는 GIL 없이 다른 스레드가 사용 중일 수 있음)
+static void requireUnloaded(const NemoTokenizer& self, const char* name) {
+    if (self.isLoaded()) {
+        throw py::value_error(std::string(name) + ": settings apply to the next load; set them on a new core before loading");
+    }
+}
+
+// 결과 배열을 복사 없이 버퍼 프로토콜로 노출하는 읽기 전용 뷰 (원본 객체는 keep_alive로 유지)
+template <class T>
+struct ArrayView {
+    const T* data;
+    size_t size;
+};
+
+template <class T>
+static void bindArrayView(py::module& m, const char* name) {
+    py::class_<ArrayView<T>>(m, name, py::buffer_protocol())
+        .def_buffer([](ArrayView<T>& view) {
+            return py::buffer_info(const_cast<T*>(view.data), sizeof(T), py::format_descriptor<T>::format(),
+                                   1, { static_cast<py::ssize_t>(view.size) }, { static_cast<py::ssize_t>(sizeof(T)) }, true);
+        })
+        .def("__len__", [](const ArrayView<T>& view) { return view.size; });
+}
+
+// 텍스트 시퀀스를 UTF-8 포인터/길이 배열로 변환 (문자열 복사 없음, items가 원소를 붙잡고 있는 동안 유효)
+// str/bytes 하나도 시퀀스이므로 글자별 문서로 나뉘지 않도록 거부
+static void textViews(const py::sequence& texts, std::vector<py::object>& items,
+                      std::vector<const char*>& pointers, std::vector<size_t>& lengths) {
+    if (py::isinstance<py::str>(texts) || py::isinstance<py::bytes>(texts)) {
+        throw py::type_error("texts must be a sequence of str/bytes, not a single string");
+    }
+    const size_t count = texts.size();
+    items.resize(count);
+    pointers.resize(count);
+    lengths.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        items[i] = texts[i];
+        textView(items[i], pointers[i], lengths[i]);
+    }
+}
+
+// 힙에 옮긴 결과 객체를 넘파이 배열의 base로 붙여 배열이 모두 해제될 때 함께 해제
+template <class Owner>
+static py::capsule ownerCapsule(Owner* owner) {
+    return py::capsule(owner, [](void* p) { delete static_cast<Owner*>(p); });
+}
+
+// 벡터를 힙으로 옮겨 복사 없이 1차원 넘파이 배열로 반환
+template <class T>
+static py::array_t<T> vectorArray(std::vector<T>&& values) {
+    std::vector<T>* owner = new std::vector<T>(std::move(values));
+    return py::array_t<T>({ static_cast<py::ssize_t>(owner->size()) }, owner->data(), ownerCapsule(owner));
+}
+
 PYBIND11_MODULE(nemo_tokenizer_core, m) {
     m.doc() = "C++ implementation of NemoTokenizer for Python";
+
+    py::enum_<TrieEngine>(m, "TrieEngine")
+        .value("DOUBLE_ARRAY", TrieEngine::DoubleArray)
+        .value("FROZEN", TrieEngine::Frozen)
+        .value("DENSE", TrieEngine::Dense)
+        .value("RADIX", TrieEngine::Radix);
+
+    py::enum_<SharedLoad>(m, "SharedLoad")
+        .value("FAILED", SharedLoad::Failed)
+        .value("PRIVATE", SharedLoad::Private)
+        .value("SHARED", SharedLoad::Shared);
+    
+    bindArrayView<int32_t>(m, "Int32View");
+    bindArrayView<int64_t>(m, "Int64View");
+
+    py::class_<EncodedBatch>(m, "EncodedBatch")
+        .def_property_readonly("ids", py::cpp_function([](const EncodedBatch& batch) {
+            return ArrayView<int32_t>{ batch.ids.data(), batch.ids.size() };
+        }, py::keep_alive<0, 1>()))
+        .def_property_readonly("offsets", py::cpp_function([](const EncodedBatch& batch) {
+            return ArrayView<int64_t>{ batch.offsets.data(), batch.offsets.size() };
+        }, py::keep_alive<0, 1>()))
+        .def("__len__", [](const EncodedBatch& batch) { return batch.offsets.size() - 1; });
     
     py::class_<NemoTokenizer>(m, "NemoTokenizerCore")
         .def(py::init<>())
-        .def("loadTokenizer", &NemoTokenizer::loadTokenizer)
+        .def("loadTokenizer", &NemoTokenizer::loadTokenizer, py::call_guard<py::gil_scoped_release>())
+        .def("tryLoadTokenizer", &NemoTokenizer::tryLoadTokenizer, py::arg("filename"), py::call_guard<py::gil_scoped_release>())
+        .def("loadFromBuffer", [](NemoTokenizer& self, py::buffer data) {
+            py::buffer_info info = data.request();
+            if (info.ndim != 1 || info.strides[0] != info.itemsize) {
+                throw py::value_error("loadFromBuffer: a contiguous 1-D buffer is required");
+            }
+            py::gil_scoped_release release;
+            return self.loadFromBuffer(static_cast<const char*>(info.ptr), static_cast<size_t>(info.size * info.itemsize));
+        }, py::arg("data"))
+        .def("saveCompiled", &NemoTokenizer::saveCompiled, py::arg("filename"), py::call_guard<py::gil_scoped_release>())
+        .def("loadCompiled", &NemoTokenizer::loadCompiled, py::arg("filename"), py::call_guard<py::gil_scoped_release>())
+        .def("loadShared", &NemoTokenizer::loadShared, py::arg("filename"), py::arg("directory") = "", py::call_guard<py::gil_scoped_release>())
+        .def("removeShared", &NemoTokenizer::removeShared, py::arg("filename"), py::arg("directory") = "", py::call_guard<py::gil_scoped_release>())
+        .def("setTrieEngine", [](NemoTokenizer& self, TrieEngine engine) {
+            requireUnloaded(self, "setTrieEngine");
+            self.setTrieEngine(engine);
+        }, py::arg("engine"))
+        .def("getTrieEngine", &NemoTokenizer::getTrieEngine)
+        .def("getActiveTrieEngine", &NemoTokenizer::getActiveTrieEngine)
+        .def("setInterleavedMatching", [](NemoTokenizer& self, bool enable) {
+            requireUnloaded(self, "setInterleavedMatching");
+            self.setInterleavedMatching(enable);
+        }, py::arg("enable"))
+        .def("getInterleavedMatching", &NemoTokenizer::getInterleavedMatching)
+        .def("setDecodeTables", [](NemoTokenizer& self, bool enable) {
+            requireUnloaded(self, "setDecodeTables");
+            self.setDecodeTables(enable);
+        }, py::arg("enable"))
+        .def("getDecodeTables", &NemoTokenizer::getDecodeTables)
+        .def("isLoaded", &NemoTokenizer::isLoaded)
+        .def("memory_usage", &NemoTokenizer::memoryUsage, py::call_guard<py::gil_scoped_release>())
         .def("tokenize", &NemoTokenizer::tokenize, 
-            py::arg("text"), py::arg("add_special_tokens") = true)
+            py::arg("text"), py::arg("add_special_tokens") = true, py::call_guard<py::gil_scoped_release>())
         .def("batch_tokenize", &NemoTokenizer::batch_tokenize, 
-            py::arg("text"), py::arg("add_special_tokens") = true)
-        .def("encode", &NemoTokenizer::encode, 
-            py::arg("text"), py::arg("add_special_tokens") = true)
+            py::arg("text"), py::arg("add_special_tokens") = true, py::call_guard<py::gil_scoped_release>())
+        .def("encode", py::overload_cast<const std::string&, bool>(&NemoTokenizer::encode, py::const_), 
+            py::arg("text"), py::arg("add_special_tokens") = true, py::call_guard<py::gil_scoped_release>())
+        .def("encode_into", [](const NemoTokenizer& self, py::handle text, py::buffer out, bool add_special_tokens) {
+            const char* data;
+            size_t length;
+            textView(text, data, length);
+            py::buffer_info info = out.request(true);
+            size_t capacity;
+            int32_t* ids = idBuffer(info, capacity);
+            py::gil_scoped_release release;
+            return self.encode_into(data, length, ids, capacity, add_special_tokens);
+        }, py::arg("text"), py::arg("out"), py::arg("add_special_tokens") = true)
+        .def("batch_encode", [](const NemoTokenizer& self, py::sequence texts, bool add_special_tokens) {
+            std::vector<py::object> items;
+            std::vector<const char*> pointers;
+            std::vector<size_t> lengths;
+            textViews(texts, items, pointers, lengths);
+            py::gil_scoped_release release;
+            return self.batch_encode(pointers.data(), lengths.data(), pointers.size(), add_special_tokens);
+        }, py::arg("texts"), py::arg("add_special_tokens") = true)
+        .def("encode_np", [](const NemoTokenizer& self, py::handle text, bool add_special_tokens) {
+            const char* data;
+            size_t length;
+            textView(text, data, length);
+            std::vector<int> ids;
+            {
+                py::gil_scoped_release release;
+                ids = self.encode(data, length, add_special_tokens);
+            }
+            return vectorArray(std::move(ids));
+        }, py::arg("text"), py::arg("add_special_tokens") = true)
+        .def("batch_encode_np", [](const NemoTokenizer& self, py::sequence texts, bool add_special_tokens) {
+            std::vector<py::object> items;
+            std::vector<const char*> pointers;
+            std::vector<size_t> lengths;
+            textViews(texts, items, pointers, lengths);
+            EncodedBatch* batch = new EncodedBatch();
+            py::capsule owner = ownerCapsule(batch);
+            {
+                py::gil_scoped_release release;
+                *batch = self.batch_encode(pointers.data(), lengths.data(), pointers.size(), add_special_tokens);
+            }
+            return py::make_tuple(
+                py::array_t<int32_t>({ static_cast<py::ssize_t>(batch->ids.size()) }, batch->ids.data(), owner),
+                py::array_t<int64_t>({ static_cast<py::ssize_t>(batch->offsets.size()) }, batch->offsets.data(), owner));
+        }, py::arg("texts"), py::arg("add_special_tokens") = true)
+        .def("batch_encode_padded", [](const NemoTokenizer& self, py::sequence texts, bool add_special_tokens,
+                                       size_t max_length, bool truncation, bool pad_to_max_length, bool pad_left,
+                                       size_t pad_to_multiple_of, int pad_id) {
+            std::vector<py::object> items;
+            std::vector<const char*> pointers;
+            std::vector<size_t> lengths;
+            textViews(texts, items, pointers, lengths);
+            PaddingOptions options;
+            options.maxLength = max_length;
+            options.truncation = truncation;
+            options.padToMaxLength = pad_to_max_length;
+            options.padLeft = pad_left;
+            options.padToMultipleOf = pad_to_multiple_of;
+            options.padId = pad_id;
+            PaddedBatch* batch = new PaddedBatch();
+            py::capsule owner = ownerCapsule(batch);
+            {
+                py::gil_scoped_release release;
+                *batch = self.batch_encode_padded(pointers.data(), lengths.data(), pointers.size(), options, add_special_tokens);
+            }
+            const std::vector<py::ssize_t> shape = { static_cast<py::ssize_t>(batch->batchSize),
+                                                     static_cast<py::ssize_t>(batch->sequenceLength) };
+            return py::make_tuple(py::array_t<int32_t>(shape, batch->inputIds.data(), owner),
+                                  py::array_t<int32_t>(shape, batch->attentionMask.data(), owner),
+                                  py::array_t<int32_t>(shape, batch->tokenTypeIds.data(), owner));
+        }, py::arg("texts"), py::arg("add_special_tokens") = true, py::arg("max_length") = 0,
+           py::arg("truncation") = false, py::arg("pad_to_max_length") = false, py::arg("pad_left") = false,
+           py::arg("pad_to_multiple_of") = 0, py::arg("pad_id") = -1)
+        .def("padTokenId", &NemoTokenizer::padTokenId, py::call_guard<py::gil_scoped_release>())
         .def("decode", &NemoTokenizer::decode, 
-            py::arg("ids"), py::arg("skip_special_tokens") = true)
+            py::arg("ids"), py::arg("skip_special_tokens") = true, py::call_guard<py::gil_scoped_release>())
         .def("convert_tokens_to_ids", &NemoTokenizer::convert_tokens_to_ids,
-            py::arg("tokens"), py::arg("add_special_tokens") = true)
+            py::arg("tokens"), py::arg("add_special_tokens") = true, py::call_guard<py::gil_scoped_release>())
         .def("convert_ids_to_tokens", &NemoTokenizer::convert_ids_to_tokens,
-            py::arg("ids"), py::arg("skip_special_tokens") = true)
+            py::arg("ids"), py::arg("skip_special_tokens") = true, py::call_guard<py::gil_scoped_release>())
         .def("convert_tokens_to_text", &NemoTokenizer::convert_tokens_to_text,
-            py::arg("tokens"), py::arg("skip_special_tokens") = true);
+            py::arg("tokens"), py::arg("skip_special_tokens") = true, py::call_guard<py::gil_scoped_release>());
 }
\ No newline at end of file
@@ -0,0 +1,241 @@
+#pragma once
+#ifndef BYTE_CLASS_TRIE_H
+#define BYTE_CLASS_TRIE_H
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include "prefetch.h"
+#include "compiled_image.h"
+
+/****************************************************************
+* Class Name: ByteClassTrie
+* Description: 바이트 동치 클래스로 축소한 전이 테이블을 쓰는 Dense Trie
+*              (기존 TRIE_SEARCH_TYPE 1, children[256] 방식의 대체)
+*              노드는 UTF-8 위치(문자 경계 / 남은 연속 바이트 1~3개)에 따라
+*              4개 그룹으로 나뉘며, 그룹마다 어휘에서 한 번도 쓰이지 않는
+*              바이트는 모두 0번(dead) 클래스로 합쳐짐
+*              전이: child = table[row(s) + classOf[group(s)][ch]]
+*              연속 바이트 위치의 노드는 최대 65칸, 경계 위치의 노드도
+*              어휘에 쓰인 바이트 수만큼만 차지함
+****************************************************************/
+class ByteClassTrie {
+public:
+    enum : uint32_t { NONE = 0xFFFFFFFFu };
+    enum { GROUP_COUNT = 4 };
+
+    struct Node {
+        uint32_t row;  // table에서 이 노드 전이 행의 시작 위치 (자식이 없으면 0: dead 행)
+        int32_t id;    // 토큰 ID (종료 노드가 아니면 -1)
+        uint8_t group; // UTF-8 위치 그룹
+        uint8_t flags; // bit0: 특수 토큰 여부
+        uint16_t reserved;
+    };
+
+    enum : uint8_t { FLAG_SPECIAL = 1 };
+
+    ByteClassTrie() { clear(); }
+
+    // 검색용 포인터가 자기 벡터를 가리키므로 복사는 금지하고 이동만 허용
+    ByteClassTrie(const ByteClassTrie&) = delete;
+    ByteClassTrie& operator=(const ByteClassTrie&) = delete;
+    ByteClassTrie(ByteClassTrie&&) = default;
+    ByteClassTrie& operator=(ByteClassTrie&&) = default;
+
+    void clear() {
+        nodes.clear();
+        nodes.shrink_to_fit();
+        table.clear();
+        table.shrink_to_fit();
+        nodeData = nullptr;
+        tableData = nullptr;
+        nodeSize = 0;
+        tableSize = 0;
+        buildLabels.clear();
+        buildFirstChild.clear();
+        buildChildCount.clear();
+        std::memset(classOf, 0, sizeof(classOf));
+        std::memset(classCount, 0, sizeof(classCount));
+    }
+
+    bool empty() const { return nodeSize == 0; }
+
+    uint32_t root() const { return 0; }
+
+    // 한 바이트 전이 (성공 시 state 갱신)
+    inline bool next(uint32_t& state, unsigned char ch) const {
+        const Node& node = nodeData[state];
+        const uint32_t t = tableData[node.row + classOf[node.group][ch]];
+        if (!t) return false; // 0번 노드(루트)는 누구의 자식도 아니므로 0을 "없음"으로 사용
+        state = t;
+        return true;
+    }
+
+    // state에서 ch로 전이할 때 읽을 테이블 칸을 미리 가져옴
+    inline void prefetch(uint32_t state, unsigned char ch) const {
+        const Node& node = nodeData[state];
+        PrefetchRead(&tableData[node.row + classOf[node.group][ch]]);
+    }
+
+    inline int value(uint32_t state) const { return nodeData[state].id; }
+
+    inline bool isSpecial(uint32_t state) const { return (nodeData[state].flags & FLAG_SPECIAL) != 0; }
+
+    size_t size() const { return nodeSize; }
+
+    // 그룹별 클래스 수 (dead 클래스 포함)
+    uint32_t classes(int group) const { return classCount[group]; }
+
+    size_t memoryUsage() const {
+        return std::max(nodes.capacity(), nodeSize) * sizeof(Node) + std::max(table.capacity(), tableSize) * sizeof(uint32_t) + sizeof(classOf);
+    }
+
+    // 컴파일된 이미지에 노드 배열, 전이 테이블, 클래스 표를 기록합니다.
+    void save(CompiledWriter& writer) const {
+        writer.add(CompiledTag('B', 'C', 'N', 'D'), nodeData, nodeSize);
+        writer.add(CompiledTag('B', 'C', 'T', 'B'), tableData, tableSize);
+        writer.add(CompiledTag('B', 'C', 'C', 'O'), &classOf[0][0], sizeof(classOf));
+        writer.add(CompiledTag('B', 'C', 'C', 'C'), classCount, GROUP_COUNT);
+    }
+
+    /**
+     * 컴파일된 이미지의 노드 배열과 전이 테이블을 복사 없이 사용합니다. (클래스 표만 복사)
+     * @return 필요한 섹션이 모두 있고 올바르면 true
+     */
+    bool attach(const CompiledReader& reader) {
+        const Node* nodeArray;
+        const uint32_t* tableArray;
+        const uint8_t* classArray;
+        const uint32_t* countArray;
+        size_t count, rows, classBytes, groups;
+        if (!reader.get(CompiledTag('B', 'C', 'N', 'D'), nodeArray, count) || count == 0) return false;
+        if (!reader.get(CompiledTag('B', 'C', 'T', 'B'), tableArray, rows) || rows == 0) return false;
+        if (!reader.get(CompiledTag('B', 'C', 'C', 'O'), classArray, classBytes) || classBytes != sizeof(classOf)) return false;
+        if (!reader.get(CompiledTag('B', 'C', 'C', 'C'), countArray, groups) || groups != GROUP_COUNT) return false;
+        clear();
+        nodeData = nodeArray;
+        tableData = tableArray;
+        nodeSize = count;
+        tableSize = rows;
+        std::memcpy(classOf, classArray, sizeof(classOf));
+        std::memcpy(classCount, countArray, sizeof(classCount));
+        return true;
+    }
+
+    // UTF-8 디코더 상태 전이: 부모 그룹과 들어오는 바이트로 자식 노드의 그룹을 결정
+    static uint8_t nextGroup(uint8_t group, unsigned char ch) {
+        if (group != 0 && (ch & 0xC0) == 0x80) return static_cast<uint8_t>(group - 1);
+        if ((ch & 0xE0) == 0xC0) return 1;
+        if ((ch & 0xF0) == 0xE0) return 2;
+        if ((ch & 0xF8) == 0xF0) return 3;
+        return 0; // ASCII 또는 잘못된 바이트는 문자 경계로 취급
+    }
+
+    /**
+     * 빌드를 시작합니다. 노드는 FrozenTrie와 같이 BFS 순서로 추가합니다.
+     * @param nodeCount 전체 노드 수 (루트 포함)
+     */
+    void beginBuild(size_t nodeCount) {
+        clear();
+        nodes.reserve(nodeCount);
+        buildLabels.reserve(nodeCount);
+        buildFirstChild.reserve(nodeCount);
+        buildChildCount.reserve(nodeCount);
+    }
+
+    // BFS 순서로 다음 노드를 추가합니다. (그룹과 전이 행은 finishBuild에서 결정)
+    uint32_t appendNode(unsigned char label, int id, bool special) {
+        Node node = { 0, id, 0, static_cast<uint8_t>(special ? FLAG_SPECIAL : 0), 0 };
+        nodes.push_back(node);
+        buildLabels.push_back(label);
+        buildFirstChild.push_back(0);
+        buildChildCount.push_back(0);
+        return static_cast<uint32_t>(nodes.size() - 1);
+    }
+
+    // 노드의 자식 구간을 설정합니다. (자식들은 이미 연속으로 추가되어 있어야 함)
+    void setChildren(uint32_t index, uint32_t firstChild, uint32_t childCount) {
+        buildFirstChild[index] = firstChild;
+        buildChildCount[index] = childCount;
+    }
+
+    // 그룹 계산 → 그룹별 바이트 클래스 계산 → 전이 테이블 구성
+    void finishBuild() {
+        const size_t count = nodes.size();
+
+        // 1. BFS 순서이므로 부모가 항상 먼저 처리됨
+        bool used[GROUP_COUNT][256];
+        std::memset(used, 0, sizeof(used));
+        for (size_t n = 0; n < count; ++n) {
+            const uint8_t group = nodes[n].group;
+            for (uint32_t c = buildFirstChild[n], e = c + buildChildCount[n]; c < e; ++c) {
+                nodes[c].group = nextGroup(group, buildLabels[c]);
+                used[group][buildLabels[c]] = true;
+            }
+        }
+
+        // 2. 그룹마다 한 번이라도 쓰인 바이트만 고유 클래스를 받고 나머지는 0번 클래스
+        uint32_t maxClasses = 1;
+        for (int g = 0; g < GROUP_COUNT; ++g) {
+            uint32_t next = 1;
+            for (int ch = 0; ch < 256; ++ch) {
+                classOf[g][ch] = used[g][ch] ? static_cast<uint8_t>(next++) : 0;
+            }
+            // 256개 바이트가 모두 쓰이면 클래스 번호가 넘치므로 0번을 따로 두지 않음
+            if (next > 256) {
+                for (int ch = 0; ch < 256; ++ch) classOf[g][ch] = static_cast<uint8_t>(ch);
+                next = 256;
+            }
+            classCount[g] = next;
+            if (next > maxClasses) maxClasses = next;
+        }
+
+        // 3. 0번 행은 모든 클래스에 대해 "없음"인 dead 행 (자식 없는 노드가 공유)
+        size_t rows = maxClasses;
+        for (size_t n = 0; n < count; ++n) {
+            if (buildChildCount[n]) rows += classCount[nodes[n].group];
+        }
+        table.assign(rows, 0);
+
+        uint32_t offset = maxClasses;
+        for (size_t n = 0; n < count; ++n) {
+            if (!buildChildCount[n]) continue;
+            const uint8_t group = nodes[n].group;
+            nodes[n].row = offset;
+            for (uint32_t c = buildFirstChild[n], e = c + buildChildCount[n]; c < e; ++c) {
+                table[offset + classOf[group][buildLabels[c]]] = c;
+            }
+            offset += classCount[group];
+        }
+
+        buildLabels.clear();
+        buildLabels.shrink_to_fit();
+        buildFirstChild.clear();
+        buildFirstChild.shrink_to_fit();
+        buildChildCount.clear();
+        buildChildCount.shrink_to_fit();
+
+        nodeData = nodes.data();
+        tableData = table.data();
+        nodeSize = nodes.size();
+        tableSize = table.size();
+    }
+
+private:
+    std::vector<Node> nodes;                 // BFS 순서의 노드 배열 (컴파일된 이미지를 쓰면 비어 있음)
+    std::vector<uint32_t> table;             // 클래스 단위 전이 테이블 (0: 없음)
+    const Node* nodeData;                    // 검색에 쓰는 배열 (nodes/table 또는 매핑된 이미지)
+    const uint32_t* tableData;
+    size_t nodeSize;
+    size_t tableSize;
+    uint8_t classOf[GROUP_COUNT][256];       // 그룹별 바이트 -> 클래스
+    uint32_t classCount[GROUP_COUNT];        // 그룹별 클래스 수
+
+    // 빌드 전용 임시 배열
+    std::vector<uint8_t> buildLabels;
+    std::vector<uint32_t> buildFirstChild;
+    std::vector<uint32_t> buildChildCount;
+};
+
+#endif
@@ -0,0 +1,347 @@
+#pragma once
+#ifndef COMPILED_IMAGE_H
+#define COMPILED_IMAGE_H
+
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// 섹션 태그 (4문자 코드)
+constexpr uint32_t CompiledTag(char a, char b, char c, char d) {
+    return static_cast<uint32_t>(static_cast<unsigned char>(a))
+         | (static_cast<uint32_t>(static_cast<unsigned char>(b)) << 8)
+         | (static_cast<uint32_t>(static_cast<unsigned char>(c)) << 16)
+         | (static_cast<uint32_t>(static_cast<unsigned char>(d)) << 24);
+}
+
+/****************************************************************
+* Struct Name: CompiledHeader / CompiledSection
+* Description: 컴파일된 토크나이저 파일 형식
+*              [헤더][섹션 디렉터리][64바이트 정렬된 섹션 데이터...]
+*              체크섬은 헤더 뒤의 모든 바이트(디렉터리 + 데이터)에 대해 계산
+*              섹션은 배열을 그대로 담으므로 로드 시 포인터만 연결함
+****************************************************************/
+struct CompiledHeader {
+    char magic[8];          // "NEMOTOKC"
+    uint32_t version;       // 형식 버전 (구조체 배치가 바뀌면 증가)
+    uint32_t byteOrder;     // 0x01020304 (다른 엔디언에서 만든 파일 거부)
+    uint32_t sectionCount;  // 섹션 디렉터리 항목 수
+    uint32_t reserved;
+    uint64_t fileSize;      // 전체 파일 크기
+    uint64_t checksum;      // 헤더 이후 바이트의 체크섬
+};
+
+struct CompiledSection {
+    uint32_t tag;           // CompiledTag로 만든 섹션 이름
+    uint32_t elementSize;   // 원소 하나의 바이트 수 (구조체 크기 검증용)
+    uint64_t offset;        // 파일 시작부터의 위치 (64바이트 정렬)
+    uint64_t size;          // 바이트 수
+};
+
+enum : uint32_t { COMPILED_VERSION = 4, COMPILED_BYTE_ORDER = 0x01020304u };
+enum : size_t { COMPILED_ALIGNMENT = 64 };
+
+// 8바이트 단위 FNV-1a 변형 체크섬 (손상/잘린 파일 검출용)
+inline uint64_t CompiledChecksum(const char* data, size_t size) {
+    uint64_t h = 1469598103934665603ULL;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t w;
+        std::memcpy(&w, data + i, 8);
+        h = (h ^ w) * 1099511628211ULL;
+    }
+    for (; i < size; ++i) {
+        h = (h ^ static_cast<unsigned char>(data[i])) * 1099511628211ULL;
+    }
+    return h;
+}
+
+/****************************************************************
+* Class Name: CompiledWriter
+* Description: 섹션들을 모아 컴파일된 토크나이저 파일로 기록
+*              배열 섹션은 포인터만 보관하므로 write 전까지 원본이 살아 있어야 함
+****************************************************************/
+class CompiledWriter {
+public:
+    // 배열 섹션 추가
+    template <class T>
+    void add(uint32_t tag, const T* data, size_t count) {
+        Pending p = { tag, static_cast<uint32_t>(sizeof(T)), reinterpret_cast<const char*>(data), count * sizeof(T), std::string() };
+        sections.push_back(p);
+    }
+
+    // 값 하나를 복사하여 섹션으로 추가
+    template <class T>
+    void addValue(uint32_t tag, const T& value) {
+        Pending p = { tag, static_cast<uint32_t>(sizeof(T)), nullptr, sizeof(T), std::string(reinterpret_cast<const char*>(&value), sizeof(T)) };
+        sections.push_back(p);
+    }
+
+    /**
+     * 파일로 기록합니다.
+     * @param path 출력 파일 경로
+     * @return 성공 여부
+     */
+    bool write(const std::string& path) const {
+        const size_t directoryEnd = sizeof(CompiledHeader) + sections.size() * sizeof(CompiledSection);
+
+        std::vector<CompiledSection> directory(sections.size());
+        size_t offset = align(directoryEnd);
+        for (size_t i = 0; i < sections.size(); ++i) {
+            directory[i].tag = sections[i].tag;
+            directory[i].elementSize = sections[i].elementSize;
+            directory[i].offset = offset;
+            directory[i].size = sections[i].size;
+            offset = align(offset + sections[i].size);
+        }
+
+        std::vector<char> image(offset, 0);
+        std::memcpy(image.data() + sizeof(CompiledHeader), directory.data(), directory.size() * sizeof(CompiledSection));
+        for (size_t i = 0; i < sections.size(); ++i) {
+            const char* src = sections[i].data ? sections[i].data : sections[i].copy.data();
+            if (sections[i].size) std::memcpy(image.data() + directory[i].offset, src, sections[i].size);
+        }
+
+        CompiledHeader header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, "NEMOTOKC", 8);
+        header.version = COMPILED_VERSION;
+        header.byteOrder = COMPILED_BYTE_ORDER;
+        header.sectionCount = static_cast<uint32_t>(sections.size());
+        header.fileSize = image.size();
+        header.checksum = CompiledChecksum(image.data() + sizeof(CompiledHeader), image.size() - sizeof(CompiledHeader));
+        std::memcpy(image.data(), &header, sizeof(header));
+
+        FILE* fp = std::fopen(path.c_str(), "wb");
+        if (!fp) return false;
+        const bool ok = std::fwrite(image.data(), 1, image.size(), fp) == image.size();
+        return (std::fclose(fp) == 0) && ok;
+    }
+
+private:
+    struct Pending {
+        uint32_t tag;
+        uint32_t elementSize;
+        const char* data;  // 배열 섹션 (nullptr이면 copy 사용)
+        size_t size;
+        std::string copy;  // addValue로 추가한 값
+    };
+    std::vector<Pending> sections;
+
+    static size_t align(size_t n) { return (n + COMPILED_ALIGNMENT - 1) & ~(COMPILED_ALIGNMENT - 1); }
+};
+
+/****************************************************************
+* Class Name: CompiledReader
+* Description: 메모리에 올라온(mmap) 컴파일된 토크나이저 이미지를 검증하고
+*              섹션을 복사 없이 포인터로 제공
+****************************************************************/
+class CompiledReader {
+public:
+    CompiledReader(): base(nullptr), length(0), directory(nullptr), sectionCount(0) {}
+
+    /**
+     * 헤더, 버전, 체크섬, 섹션 범위를 검증합니다.
+     * @param data 이미지 시작 (64바이트 이상 정렬)
+     * @param size 이미지 크기
+     * @param verifyChecksum 체크섬 확인 여부 (바이너리에 링크된 이미지처럼 손상될 수 없으면 생략하여 전체를 읽지 않음)
+     * @return 유효한 이미지면 true
+     */
+    bool open(const char* data, size_t size, bool verifyChecksum = true) {
+        base = nullptr;
+        if (!data || size < sizeof(CompiledHeader)) return false;
+
+        CompiledHeader header;
+        std::memcpy(&header, data, sizeof(header));
+        if (std::memcmp(header.magic, "NEMOTOKC", 8) != 0) return false;
+        if (header.version != COMPILED_VERSION || header.byteOrder != COMPILED_BYTE_ORDER) return false;
+        if (header.fileSize != size) return false;
+        if (header.sectionCount > (size - sizeof(CompiledHeader)) / sizeof(CompiledSection)) return false;
+        if (verifyChecksum && CompiledChecksum(data + sizeof(CompiledHeader), size - sizeof(CompiledHeader)) != header.checksum) return false;
+
+        const CompiledSection* dir = reinterpret_cast<const CompiledSection*>(data + sizeof(CompiledHeader));
+        for (uint32_t i = 0; i < header.sectionCount; ++i) {
+            if (dir[i].offset > size || dir[i].size > size - dir[i].offset) return false;
+            if (dir[i].offset % COMPILED_ALIGNMENT) return false;
+        }
+
+        base = data;
+        length = size;
+        directory = dir;
+        sectionCount = header.sectionCount;
+        return true;
+    }
+
+    // 배열 섹션을 찾습니다. (원소 크기가 다르면 실패)
+    template <class T>
+    bool get(uint32_t tag, const T*& data, size_t& count) const {
+        for (uint32_t i = 0; i < sectionCount; ++i) {
+            if (directory[i].tag != tag) continue;
+            if (directory[i].elementSize != sizeof(T) || directory[i].size % sizeof(T)) return false;
+            data = reinterpret_cast<const T*>(base + directory[i].offset);
+            count = static_cast<size_t>(directory[i].size / sizeof(T));
+            return true;
+        }
+        return false;
+    }
+
+    // 값 하나짜리 섹션을 복사해 옵니다.
+    template <class T>
+    bool getValue(uint32_t tag, T& value) const {
+        const T* data;
+        size_t count;
+        if (!get(tag, data, count) || count != 1) return false;
+        std::memcpy(&value, data, sizeof(T));
+        return true;
+    }
+
+private:
+    const char* base;
+    size_t length;
+    const CompiledSection* directory;
+    uint32_t sectionCount;
+};
+
+/****************************************************************
+* Class Name: MappedFile
+* Description: 읽기 전용 파일 메모리 매핑 (POSIX mmap / Windows MapViewOfFile)
+*              같은 파일을 매핑한 모든 프로세스가 같은 물리 페이지(페이지 캐시)를 공유
+****************************************************************/
+class MappedFile {
+public:
+    MappedFile(): base(nullptr), length(0) {}
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path) {
+        close();
+#if defined(_WIN32)
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+            CloseHandle(file);
+            return false;
+        }
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file);
+        if (!mapping) return false;
+        void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping); // 뷰가 매핑을 계속 참조함
+        if (!view) return false;
+        base = static_cast<const char*>(view);
+        length = static_cast<size_t>(fileSize.QuadPart);
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0) {
+            ::close(fd);
+            return false;
+        }
+        void* view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd); // 매핑은 파일 디스크립터와 무관하게 유지됨
+        if (view == MAP_FAILED) return false;
+        base = static_cast<const char*>(view);
+        length = static_cast<size_t>(st.st_size);
+#endif
+        return true;
+    }
+
+    void close() {
+        if (!base) return;
+#if defined(_WIN32)
+        UnmapViewOfFile(base);
+#else
+        munmap(const_cast<char*>(base), length);
+#endif
+        base = nullptr;
+        length = 0;
+    }
+
+    const char* data() const { return base; }
+    size_t size() const { return length; }
+
+private:
+    const char* base;
+    size_t length;
+};
+
+// 파일 크기와 수정 시각(초)을 구합니다.
+inline bool CompiledFileStat(const std::string& path, uint64_t& size, int64_t& modified) {
+#if defined(_WIN32)
+    struct _stat64 st;
+    if (_stat64(path.c_str(), &st) != 0) return false;
+#else
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) return false;
+#endif
+    size = static_cast<uint64_t>(st.st_size);
+    modified = static_cast<int64_t>(st.st_mtime);
+    return true;
+}
+
+// 절대 경로 (구할 수 없으면 입력 그대로)
+inline std::string CompiledAbsolutePath(const std::string& path) {
+#if defined(_WIN32)
+    char* full = _fullpath(nullptr, path.c_str(), 0);
+#else
+    char* full = realpath(path.c_str(), nullptr);
+#endif
+    if (!full) return path;
+    std::string result(full);
+    std::free(full);
+    return result;
+}
+
+// 프로세스 간 공유 이미지를 둘 기본 디렉터리 (Linux는 메모리 기반 /dev/shm, 그 외는 임시 디렉터리)
+inline std::string CompiledSharedDirectory() {
+#if defined(_WIN32)
+    char buffer[MAX_PATH + 1];
+    const DWORD length = GetTempPathA(sizeof(buffer), buffer);
+    return (length > 0 && length <= MAX_PATH) ? std::string(buffer, length) : std::string(".");
+#else
+    if (access("/dev/shm", W_OK) == 0) return "/dev/shm";
+    const char* tmp = std::getenv("TMPDIR");
+    return (tmp && *tmp) ? std::string(tmp) : std::string("/tmp");
+#endif
+}
+
+// from을 to로 원자적으로 교체합니다. (이미 있으면 덮어씀)
+inline bool CompiledReplaceFile(const std::string& from, const std::string& to) {
+#if defined(_WIN32)
+    return MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    return std::rename(from.c_str(), to.c_str()) == 0;
+#endif
+}
+
+// 현재 프로세스 ID (임시 파일 이름 충돌 방지용)
+inline unsigned long CompiledProcessId() {
+#if defined(_WIN32)
+    return static_cast<unsigned long>(GetCurrentProcessId());
+#else
+    return static_cast<unsigned long>(getpid());
+#endif
+}
+
+#endif
@@ -0,0 +1,276 @@
+#pragma once
+#ifndef DOUBLE_ARRAY_TRIE_H
+#define DOUBLE_ARRAY_TRIE_H
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include "prefetch.h"
+#include "compiled_image.h"
+
+/****************************************************************
+* Class Name: DoubleArrayTrie
+* Description: base/check 배열 기반의 Double-Array Trie
+*              노드당 256개의 포인터 대신 16바이트 유닛 하나만 사용
+*              전이: t = base[s] + ch, check[t] == s 이면 유효
+*              유닛마다 경로상 가장 깊은 종료 노드(최장 일치)와 남은 최대
+*              깊이를 함께 저장하여 최장 일치 탐색 시 단계마다 토큰 ID를
+*              확인하지 않고, 더 내려갈 수 없는 노드에서 바로 멈춤
+****************************************************************/
+class DoubleArrayTrie {
+public:
+    enum : uint32_t { NONE = 0xFFFFFFFFu };
+
+    struct Unit {
+        uint32_t base;   // 자식 전이의 시작 오프셋
+        uint32_t check;  // 부모 상태 (미사용 슬롯은 NONE)
+        int32_t value;   // 종료 노드면 토큰 ID, 아니면 경로상 가장 깊은 종료 노드의 토큰 ID (없으면 -1)
+        uint32_t flags;  // bit0: 특수 토큰, bit1: 종료 노드, bit8~15: 남은 최대 깊이, bit16~31: 최장 일치 이후 바이트 수
+    };
+
+    enum : uint32_t { FLAG_SPECIAL = 1u, FLAG_END = 2u };
+    enum : uint32_t { HEIGHT_SHIFT = 8, HEIGHT_MAX = 0xFFu, BACK_SHIFT = 16, BACK_MAX = 0xFFFFu };
+
+    DoubleArrayTrie(): unitData(nullptr), unitCount(0), annotated(false) {}
+
+    // 검색용 포인터가 자기 벡터를 가리키므로 복사는 금지하고 이동만 허용
+    DoubleArrayTrie(const DoubleArrayTrie&) = delete;
+    DoubleArrayTrie& operator=(const DoubleArrayTrie&) = delete;
+    DoubleArrayTrie(DoubleArrayTrie&&) = default;
+    DoubleArrayTrie& operator=(DoubleArrayTrie&&) = default;
+
+    void clear() {
+        units.clear();
+        units.shrink_to_fit();
+        nextFree.clear();
+        nextFree.shrink_to_fit();
+        unitData = nullptr;
+        unitCount = 0;
+        annotated = false;
+    }
+
+    bool empty() const { return unitCount == 0; }
+
+    uint32_t root() const { return 0; }
+
+    // 한 바이트 전이 (성공 시 state 갱신)
+    inline bool next(uint32_t& state, unsigned char ch) const {
+        const uint32_t t = unitData[state].base + ch;
+        if (unitData[t].check != state) return false;
+        state = t;
+        return true;
+    }
+
+    // state에서 ch로 전이할 때 읽을 유닛을 미리 가져옴
+    inline void prefetch(uint32_t state, unsigned char ch) const {
+        PrefetchRead(&unitData[unitData[state].base + ch]);
+    }
+
+    inline int value(uint32_t state) const {
+        return (unitData[state].flags & FLAG_END) ? unitData[state].value : -1;
+    }
+
+    inline bool isSpecial(uint32_t state) const { return (unitData[state].flags & FLAG_SPECIAL) != 0; }
+
+    /**
+     * state에서 시작해 입력의 최장 일치 토큰을 찾습니다.
+     * 남은 최대 깊이로 순회 길이를 제한하고, 마지막 상태의 주석으로 최장 일치를 한 번에 구합니다.
+     * @param matchedId 찾은 토큰 ID (없으면 변경하지 않음)
+     * @param matchedLen 찾은 토큰이 소비한 입력 바이트 수
+     */
+    inline void longestMatch(uint32_t state, const char* input, size_t length, int& matchedId, int& matchedLen) const {
+        if (!annotated) {
+            for (size_t i = 0; i < length; ++i) {
+                if (!next(state, static_cast<unsigned char>(input[i]))) break;
+                const int id = value(state);
+                if (id != -1) {
+                    matchedId = id;
+                    matchedLen = static_cast<int>(i + 1);
+                }
+            }
+            return;
+        }
+
+        const uint32_t height = (unitData[state].flags >> HEIGHT_SHIFT) & HEIGHT_MAX;
+        const size_t limit = (height == HEIGHT_MAX || height > length) ? length : height;
+
+        size_t i = 0;
+        while (i < limit && (unitData[state].flags & (HEIGHT_MAX << HEIGHT_SHIFT))) {
+            const uint32_t t = unitData[state].base + static_cast<unsigned char>(input[i]);
+            if (unitData[t].check != state) break;
+            state = t;
+            ++i;
+        }
+
+        // 마지막 상태에서 back 바이트 전의 종료 노드가 시작 상태보다 깊으면 일치
+        const Unit& u = unitData[state];
+        const size_t back = u.flags >> BACK_SHIFT;
+        if (u.value != -1 && back < i) {
+            matchedId = u.value;
+            matchedLen = static_cast<int>(i - back);
+        }
+    }
+
+    size_t size() const { return unitCount; }
+
+    size_t memoryUsage() const { return std::max(units.capacity(), unitCount) * sizeof(Unit); }
+
+    // 컴파일된 이미지에 유닛 배열을 기록합니다.
+    void save(CompiledWriter& writer) const {
+        writer.add(CompiledTag('D', 'A', 'U', 'N'), unitData, unitCount);
+        writer.addValue(CompiledTag('D', 'A', 'H', 'D'), static_cast<uint32_t>(annotated ? 1 : 0));
+    }
+
+    /**
+     * 컴파일된 이미지의 유닛 배열을 복사 없이 사용합니다. (이미지는 Trie보다 오래 살아 있어야 함)
+     * @return 필요한 섹션이 모두 있고 올바르면 true
+     */
+    bool attach(const CompiledReader& reader) {
+        const Unit* data;
+        size_t count;
+        uint32_t header;
+        if (!reader.get(CompiledTag('D', 'A', 'U', 'N'), data, count) || count < 257) return false;
+        if (!reader.getValue(CompiledTag('D', 'A', 'H', 'D'), header)) return false;
+        clear();
+        unitData = data;
+        unitCount = count;
+        annotated = (header & 1) != 0;
+        return true;
+    }
+
+    /**
+     * 빌드를 시작합니다. 루트(0번 상태)만 배치된 상태로 초기화합니다.
+     * @param estimatedNodes 예상 노드 수 (배열 초기 크기 결정용)
+     */
+    void beginBuild(size_t estimatedNodes) {
+        units.clear();
+        nextFree.clear();
+        unitData = nullptr;
+        unitCount = 0;
+        grow(std::max<size_t>(estimatedNodes + 257, 1024));
+        markUsed(0);
+        units[0].check = NONE;
+        maxBase = 0;
+        annotated = false;
+    }
+
+    void setValue(uint32_t state, int id, bool special) {
+        units[state].value = id;
+        units[state].flags = (id != -1 ? uint32_t(FLAG_END) : 0u) | (special ? uint32_t(FLAG_SPECIAL) : 0u);
+    }
+
+    /**
+     * 최장 일치 탐색용 주석을 설정합니다. (모든 상태에 setValue 이후 호출)
+     * @param bestId 루트부터 state까지의 경로에서 가장 깊은 종료 노드의 토큰 ID (없으면 -1)
+     * @param back 그 종료 노드에서 state까지의 바이트 수
+     * @param height state 아래로 남은 최대 깊이 (255 이상은 255로 저장하고 제한 없음으로 취급)
+     * @return back이 16비트를 넘어 주석을 쓸 수 없으면 false
+     */
+    bool setAnnotation(uint32_t state, int bestId, size_t back, size_t height) {
+        Unit& u = units[state];
+        if (bestId != -1 && back > BACK_MAX) return false;
+        if (!(u.flags & FLAG_END)) u.value = bestId;
+        u.flags &= FLAG_SPECIAL | FLAG_END;
+        u.flags |= static_cast<uint32_t>(std::min<size_t>(height, HEIGHT_MAX)) << HEIGHT_SHIFT;
+        if (bestId != -1) u.flags |= static_cast<uint32_t>(back) << BACK_SHIFT;
+        return true;
+    }
+
+    // 모든 상태에 주석을 설정했으면 true로 켜서 longestMatch가 주석을 사용하게 함
+    void setAnnotated(bool enable) { annotated = enable; }
+
+    /**
+     * 부모 상태 아래에 자식 전이들을 한 번에 배치합니다.
+     * @param parent 부모 상태
+     * @param labels 오름차순으로 정렬된 자식 바이트 목록
+     * @param count 자식 수
+     * @param outStates 각 자식에 배치된 상태 번호 (labels와 같은 순서)
+     */
+    void placeChildren(uint32_t parent, const unsigned char* labels, size_t count, uint32_t* outStates) {
+        if (count == 0) return;
+
+        const uint32_t first = labels[0];
+        uint32_t pos = findFree(first + 1);
+        uint32_t base;
+        for (;;) {
+            base = pos - first;
+            if (static_cast<size_t>(base) + 256 >= units.size()) {
+                grow(units.size() * 2);
+            }
+            bool fits = true;
+            for (size_t i = 1; i < count; ++i) {
+                if (units[base + labels[i]].check != NONE) {
+                    fits = false;
+                    break;
+                }
+            }
+            if (fits) break;
+            pos = findFree(pos + 1);
+        }
+
+        units[parent].base = base;
+        if (base > maxBase) maxBase = base;
+        for (size_t i = 0; i < count; ++i) {
+            const uint32_t t = base + labels[i];
+            units[t].check = parent;
+            markUsed(t);
+            outStates[i] = t;
+        }
+    }
+
+    // 빌드 종료: 작업용 배열 해제 및 배열 크기 확정
+    void finishBuild() {
+        size_t last = 0;
+        for (size_t i = units.size(); i-- > 0; ) {
+            if (units[i].check != NONE || i == 0) {
+                last = i;
+                break;
+            }
+        }
+        // 경계 검사 없이 base + ch 에 접근할 수 있도록 256칸 여유를 둠
+        size_t newSize = std::max(last + 1, static_cast<size_t>(maxBase) + 256 + 1);
+        units.resize(newSize);
+        units.shrink_to_fit();
+        nextFree.clear();
+        nextFree.shrink_to_fit();
+        unitData = units.data();
+        unitCount = units.size();
+    }
+
+private:
+    std::vector<Unit> units;        // 빌드한 유닛 (컴파일된 이미지를 쓰면 비어 있음)
+    const Unit* unitData;           // 검색에 쓰는 유닛 배열 (units 또는 매핑된 이미지)
+    size_t unitCount;
+    std::vector<uint32_t> nextFree; // 빌드 전용: i 이상에서 비어있는 첫 슬롯 (경로 압축)
+    uint32_t maxBase = 0;
+    bool annotated;                 // 유닛에 최장 일치 / 남은 깊이 주석이 설정되어 있는지 여부
+
+    void grow(size_t newSize) {
+        size_t oldSize = units.size();
+        if (newSize <= oldSize) return;
+        Unit empty = { 0, NONE, -1, 0 };
+        units.resize(newSize, empty);
+        nextFree.resize(newSize + 1);
+        for (size_t i = oldSize; i <= newSize; ++i) nextFree[i] = static_cast<uint32_t>(i);
+    }
+
+    uint32_t findFree(uint32_t i) {
+        if (i >= units.size()) grow(std::max<size_t>(units.size() * 2, i + 257));
+        uint32_t r = i;
+        while (nextFree[r] != r) r = nextFree[r];
+        while (nextFree[i] != r) {
+            uint32_t n = nextFree[i];
+            nextFree[i] = r;
+            i = n;
+        }
+        if (r >= units.size()) grow(std::max<size_t>(units.size() * 2, r + 257));
+        return r;
+    }
+
+    void markUsed(uint32_t i) {
+        nextFree[i] = i + 1;
+    }
+};
+
+#endif
@@ -0,0 +1,32 @@
+#pragma once
+#ifndef EMBEDDED_TOKENIZER_H
+#define EMBEDDED_TOKENIZER_H
+
+#include <cstddef>
+#include "nemo_tokenizer.h"
+
+/****************************************************************
+* Description: 빌드 시 바이너리에 포함한 토크나이저
+*              CMake에서 -DNEMO_EMBED_TOKENIZER=<tokenizer.json> 으로 설정하면
+*              nemo_embed가 컴파일된 이미지를 정적 배열로 만든 소스를 생성하고
+*              nemo_embedded_tokenizer 라이브러리로 빌드함
+*              이 헤더를 포함하고 그 라이브러리를 링크하면 파일 없이 바로 사용 가능
+****************************************************************/
+
+// nemo_embed가 생성하는 이미지 (64바이트 정렬, 읽기 전용 데이터 영역)
+const unsigned char* nemoEmbeddedImageData();
+size_t nemoEmbeddedImageSize();
+
+/**
+ * 링크된 이미지를 가리키는 토크나이저를 반환합니다.
+ * 처음 호출할 때 섹션 포인터만 연결하며 (파일 입출력, 파싱, 복사 없음) 이후에는 같은 객체를 반환합니다.
+ * @return 읽기 전용 토크나이저
+ */
+inline const NemoTokenizer& embeddedTokenizer() {
+    static NemoTokenizer tokenizer;
+    static const bool loaded = tokenizer.loadEmbedded(nemoEmbeddedImageData(), nemoEmbeddedImageSize());
+    (void)loaded;
+    return tokenizer;
+}
+
+#endif
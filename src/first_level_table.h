@@ -0,0 +1,121 @@
+#pragma once
+#ifndef FIRST_LEVEL_TABLE_H
+#define FIRST_LEVEL_TABLE_H
+
+#include <cstdint>
+#include <vector>
+#include "compiled_image.h"
+
+/****************************************************************
+* Class Name: FirstLevelTable
+* Description: 시작 상태에서 입력 앞 2바이트를 한 번에 처리하는 직접 색인 테이블
+*              table[(b0 << 8) | b1] = 2바이트를 따라간 상태 + 그때까지의 최장 일치
+*              Trie 상위 두 단계(캐시 미스가 가장 잦은 의존 로드 2번)를 건너뜀
+*              상태 번호는 검색용 Trie 엔진의 상태 번호를 그대로 사용
+****************************************************************/
+class FirstLevelTable {
+public:
+    enum : uint32_t { NONE = 0xFFFFFFFFu };
+    enum : uint32_t { TABLE_SIZE = 65536, ID_MASK = 0x3FFFFFFFu, LENGTH_SHIFT = 30 };
+
+    struct Entry {
+        uint32_t state; // 2바이트를 따라간 상태 (경로가 없으면 NONE)
+        uint32_t best;  // 하위 30비트: 최장 일치 토큰 ID + 1 (0이면 없음), 상위 2비트: 그 길이 (1 또는 2)
+    };
+
+    FirstLevelTable(): tableData(nullptr) {}
+
+    // 검색용 포인터가 자기 벡터를 가리키므로 복사는 금지하고 이동만 허용
+    FirstLevelTable(const FirstLevelTable&) = delete;
+    FirstLevelTable& operator=(const FirstLevelTable&) = delete;
+    FirstLevelTable(FirstLevelTable&&) = default;
+    FirstLevelTable& operator=(FirstLevelTable&&) = default;
+
+    bool enabled() const { return tableData != nullptr; }
+
+    void clear() {
+        table.clear();
+        table.shrink_to_fit();
+        tableData = nullptr;
+    }
+
+    inline const Entry& lookup(unsigned char b0, unsigned char b1) const {
+        return tableData[(static_cast<uint32_t>(b0) << 8) | b1];
+    }
+
+    // 최장 일치 토큰 ID (없으면 -1)
+    static inline int bestId(const Entry& e) { return static_cast<int>(e.best & ID_MASK) - 1; }
+    static inline int bestLength(const Entry& e) { return static_cast<int>(e.best >> LENGTH_SHIFT); }
+
+    size_t memoryUsage() const { return tableData ? TABLE_SIZE * sizeof(Entry) : 0; }
+
+    // 컴파일된 이미지에 테이블을 기록합니다. (비활성이면 기록하지 않음)
+    void save(CompiledWriter& writer, uint32_t tag) const {
+        if (tableData) writer.add(tag, tableData, TABLE_SIZE);
+    }
+
+    /**
+     * 컴파일된 이미지의 테이블을 복사 없이 사용합니다. 섹션이 없으면 비활성 상태가 됩니다.
+     * @param tag 섹션 태그 (루트용 / "##"용 구분)
+     * @return 섹션이 없거나 올바르면 true
+     */
+    bool attach(const CompiledReader& reader, uint32_t tag) {
+        clear();
+        const Entry* data;
+        size_t count;
+        if (!reader.get(tag, data, count)) return true;
+        if (count != TABLE_SIZE) return false;
+        tableData = data;
+        return true;
+    }
+
+    /**
+     * start 상태에서 가능한 모든 2바이트 입력을 미리 따라가 테이블을 채웁니다.
+     * 토큰 ID가 30비트에 들어가지 않으면 테이블을 만들지 않습니다. (기존 순회 사용)
+     * @param t 검색용 Trie
+     * @param start 시작 상태 (루트, "##" 상태 등)
+     */
+    template <class Trie>
+    void build(const Trie& t, uint32_t start) {
+        clear();
+        std::vector<Entry> entries(TABLE_SIZE);
+
+        for (uint32_t b0 = 0; b0 < 256; ++b0) {
+            uint32_t first = start;
+            const bool hasFirst = t.next(first, static_cast<unsigned char>(b0));
+            const int firstId = hasFirst ? t.value(first) : -1;
+
+            for (uint32_t b1 = 0; b1 < 256; ++b1) {
+                Entry& e = entries[(b0 << 8) | b1];
+                e.state = NONE;
+                e.best = 0;
+                if (!hasFirst) continue;
+
+                uint32_t second = first;
+                int id = -1;
+                uint32_t length = 0;
+                if (t.next(second, static_cast<unsigned char>(b1))) {
+                    e.state = second;
+                    id = t.value(second);
+                    length = 2;
+                }
+                if (id == -1 && firstId != -1) {
+                    id = firstId;
+                    length = 1;
+                }
+                if (id != -1) {
+                    if (static_cast<uint32_t>(id) >= ID_MASK) return;
+                    e.best = (length << LENGTH_SHIFT) | static_cast<uint32_t>(id + 1);
+                }
+            }
+        }
+        table.swap(entries);
+        tableData = table.data();
+    }
+
+private:
+    std::vector<Entry> table; // 빌드한 테이블 (컴파일된 이미지를 쓰면 비어 있음)
+    const Entry* tableData;   // 검색에 쓰는 테이블 (table 또는 매핑된 이미지)
+};
+
+#endif
@@ -0,0 +1,188 @@
+#pragma once
+#ifndef FROZEN_TRIE_H
+#define FROZEN_TRIE_H
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include "prefetch.h"
+#include "compiled_image.h"
+
+/****************************************************************
+* Class Name: FrozenTrie
+* Description: BFS 순서로 재배치된 읽기 전용 Trie 아레나
+*              노드는 32비트 인덱스로 참조하며, 한 노드의 자식들은
+*              연속된 구간 [firstChild, firstChild + childCount)에 위치
+*              얕은(자주 방문하는) 노드가 배열 앞쪽에 모여 캐시 효율이 높음
+****************************************************************/
+class FrozenTrie {
+public:
+    enum : uint32_t { NONE = 0xFFFFFFFFu };
+
+    struct Node {
+        uint32_t firstChild; // 첫 번째 자식의 인덱스
+        int32_t id;          // 토큰 ID (종료 노드가 아니면 -1)
+        uint16_t childCount; // 자식 수
+        uint8_t flags;       // bit0: 특수 토큰 여부
+        uint8_t reserved;
+    };
+
+    enum : uint8_t { FLAG_SPECIAL = 1 };
+
+    FrozenTrie(): nodeData(nullptr), labelData(nullptr), nodeSize(0) { std::memset(rootChildren, 0xFF, sizeof(rootChildren)); }
+
+    // 검색용 포인터가 자기 벡터를 가리키므로 복사는 금지하고 이동만 허용
+    FrozenTrie(const FrozenTrie&) = delete;
+    FrozenTrie& operator=(const FrozenTrie&) = delete;
+    FrozenTrie(FrozenTrie&&) = default;
+    FrozenTrie& operator=(FrozenTrie&&) = default;
+
+    void clear() {
+        nodes.clear();
+        nodes.shrink_to_fit();
+        labels.clear();
+        labels.shrink_to_fit();
+        nodeData = nullptr;
+        labelData = nullptr;
+        nodeSize = 0;
+        std::memset(rootChildren, 0xFF, sizeof(rootChildren));
+    }
+
+    bool empty() const { return nodeSize == 0; }
+
+    uint32_t root() const { return 0; }
+
+    // 한 바이트 전이 (성공 시 state 갱신)
+    inline bool next(uint32_t& state, unsigned char ch) const {
+        // 루트는 256칸 직접 테이블로 처리
+        if (state == 0) {
+            uint32_t t = rootChildren[ch];
+            if (t == NONE) return false;
+            state = t;
+            return true;
+        }
+
+        const Node& node = nodeData[state];
+        const uint8_t* begin = labelData + node.firstChild;
+        uint32_t count = node.childCount;
+
+        if (count <= 16) {
+            // 자식이 적으면 선형 탐색 (같은 캐시 라인 안에서 끝남)
+            for (uint32_t i = 0; i < count; ++i) {
+                if (begin[i] == ch) {
+                    state = node.firstChild + i;
+                    return true;
+                }
+                if (begin[i] > ch) return false;
+            }
+            return false;
+        }
+
+        // 자식이 많으면 이진 탐색 (레이블은 오름차순)
+        uint32_t lo = 0, hi = count;
+        while (lo < hi) {
+            uint32_t mid = (lo + hi) >> 1;
+            if (begin[mid] < ch) lo = mid + 1;
+            else hi = mid;
+        }
+        if (lo < count && begin[lo] == ch) {
+            state = node.firstChild + lo;
+            return true;
+        }
+        return false;
+    }
+
+    // state의 자식 레이블 구간을 미리 가져옴 (ch와 무관)
+    inline void prefetch(uint32_t state, unsigned char /*ch*/) const {
+        if (state) PrefetchRead(labelData + nodeData[state].firstChild);
+    }
+
+    inline int value(uint32_t state) const { return nodeData[state].id; }
+
+    inline bool isSpecial(uint32_t state) const { return (nodeData[state].flags & FLAG_SPECIAL) != 0; }
+
+    size_t size() const { return nodeSize; }
+
+    size_t memoryUsage() const {
+        return std::max(nodes.capacity(), nodeSize) * (sizeof(Node) + 1) + sizeof(rootChildren);
+    }
+
+    // 컴파일된 이미지에 노드/레이블 배열을 기록합니다.
+    void save(CompiledWriter& writer) const {
+        writer.add(CompiledTag('F', 'Z', 'N', 'D'), nodeData, nodeSize);
+        writer.add(CompiledTag('F', 'Z', 'L', 'B'), labelData, nodeSize);
+        writer.add(CompiledTag('F', 'Z', 'R', 'C'), rootChildren, 256);
+    }
+
+    /**
+     * 컴파일된 이미지의 배열을 복사 없이 사용합니다. (루트 직접 테이블만 복사)
+     * @return 필요한 섹션이 모두 있고 올바르면 true
+     */
+    bool attach(const CompiledReader& reader) {
+        const Node* nodeArray;
+        const uint8_t* labelArray;
+        const uint32_t* rootArray;
+        size_t count, labelCount, rootCount;
+        if (!reader.get(CompiledTag('F', 'Z', 'N', 'D'), nodeArray, count) || count == 0) return false;
+        if (!reader.get(CompiledTag('F', 'Z', 'L', 'B'), labelArray, labelCount) || labelCount != count) return false;
+        if (!reader.get(CompiledTag('F', 'Z', 'R', 'C'), rootArray, rootCount) || rootCount != 256) return false;
+        clear();
+        nodeData = nodeArray;
+        labelData = labelArray;
+        nodeSize = count;
+        std::memcpy(rootChildren, rootArray, sizeof(rootChildren));
+        return true;
+    }
+
+    /**
+     * 빌드를 시작합니다. 노드는 반드시 BFS 순서로 추가해야 합니다.
+     * @param nodeCount 전체 노드 수 (루트 포함)
+     */
+    void beginBuild(size_t nodeCount) {
+        clear();
+        nodes.reserve(nodeCount);
+        labels.reserve(nodeCount);
+    }
+
+    /**
+     * BFS 순서로 다음 노드를 추가합니다.
+     * @param label 부모에서 이 노드로 오는 바이트 (루트는 0)
+     * @return 추가된 노드의 인덱스
+     */
+    uint32_t appendNode(unsigned char label, int id, bool special) {
+        Node node = { 0, id, 0, static_cast<uint8_t>(special ? FLAG_SPECIAL : 0), 0 };
+        nodes.push_back(node);
+        labels.push_back(label);
+        return static_cast<uint32_t>(nodes.size() - 1);
+    }
+
+    // 노드의 자식 구간을 설정합니다. (자식들은 이미 연속으로 추가되어 있어야 함)
+    void setChildren(uint32_t index, uint32_t firstChild, uint32_t childCount) {
+        nodes[index].firstChild = firstChild;
+        nodes[index].childCount = static_cast<uint16_t>(childCount);
+        if (index == 0) {
+            for (uint32_t i = 0; i < childCount; ++i) {
+                rootChildren[labels[firstChild + i]] = firstChild + i;
+            }
+        }
+    }
+
+    void finishBuild() {
+        nodes.shrink_to_fit();
+        labels.shrink_to_fit();
+        nodeData = nodes.data();
+        labelData = labels.data();
+        nodeSize = nodes.size();
+    }
+
+private:
+    std::vector<Node> nodes;      // BFS 순서의 노드 배열 (컴파일된 이미지를 쓰면 비어 있음)
+    std::vector<uint8_t> labels;  // labels[i]: 노드 i로 들어오는 바이트
+    const Node* nodeData;         // 검색에 쓰는 배열 (nodes/labels 또는 매핑된 이미지)
+    const uint8_t* labelData;
+    size_t nodeSize;
+    uint32_t rootChildren[256];   // 루트 자식 직접 테이블
+};
+
+#endif
@@ -0,0 +1,156 @@
+#pragma once
+#ifndef ID_TOKEN_TABLE_H
+#define ID_TOKEN_TABLE_H
+
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+#include "compiled_image.h"
+
+/****************************************************************
+* Class Name: IdTokenTable
+* Description: ID -> 토큰 평면 테이블 (디코드용)
+*              토큰 ID는 거의 연속이므로 ID로 바로 색인하는 오프셋 배열과
+*              모든 토큰 문자열을 ID 순서로 이어붙인 blob 하나로 구성
+*              토큰 i = blob[offsets[i], offsets[i + 1])
+*              blob은 호출한 쪽이 소유함 (토큰 -> ID 해시와 공유)
+*              ID 존재 여부와 특수 토큰 여부는 ID당 1비트씩 비트셋으로 보관
+****************************************************************/
+class IdTokenTable {
+public:
+    IdTokenTable(): offsetData(nullptr), bitData(nullptr), blobData(nullptr), idLimit(0), wordCount(0), blobSize(0) {}
+
+    // 검색용 포인터가 자기 벡터를 가리키므로 복사는 금지하고 이동만 허용
+    IdTokenTable(const IdTokenTable&) = delete;
+    IdTokenTable& operator=(const IdTokenTable&) = delete;
+    IdTokenTable(IdTokenTable&&) = default;
+    IdTokenTable& operator=(IdTokenTable&&) = default;
+
+    void clear() {
+        offsets.clear();
+        offsets.shrink_to_fit();
+        bits.clear();
+        bits.shrink_to_fit();
+        offsetData = nullptr;
+        bitData = nullptr;
+        blobData = nullptr;
+        idLimit = 0;
+        wordCount = 0;
+        blobSize = 0;
+    }
+
+    // 색인할 수 있는 ID 상한 (가장 큰 ID + 1)
+    size_t size() const { return idLimit; }
+
+    inline bool contains(int id) const {
+        return static_cast<uint64_t>(id) < idLimit && testBit(0, static_cast<uint32_t>(id));
+    }
+
+    inline bool isSpecial(int id) const {
+        return static_cast<uint64_t>(id) < idLimit && testBit(wordCount, static_cast<uint32_t>(id));
+    }
+
+    /**
+     * ID에 해당하는 토큰 문자열을 찾습니다.
+     * @return 찾으면 true (token은 length 바이트, 널 종료 보장 없음)
+     */
+    inline bool find(int id, const char*& token, size_t& length, bool& special) const {
+        if (!contains(id)) return false;
+        const uint32_t begin = offsetData[id];
+        token = blobData + begin;
+        length = offsetData[id + 1] - begin;
+        special = testBit(wordCount, static_cast<uint32_t>(id));
+        return true;
+    }
+
+    // id 토큰의 blob 내 시작 위치 (contains(id)일 때만 의미 있음)
+    uint32_t offset(int id) const { return offsetData[id]; }
+
+    const char* blobBegin() const { return blobData; }
+    size_t blobLength() const { return blobSize; }
+
+    size_t memoryUsage() const {
+        return std::max(offsets.capacity(), offsetData ? idLimit + 1 : 0) * sizeof(uint32_t)
+             + std::max(bits.capacity(), wordCount * 2) * sizeof(uint64_t);
+    }
+
+    // 컴파일된 이미지에 오프셋 배열과 비트셋을 기록합니다. (blob은 호출한 쪽에서 기록)
+    void save(CompiledWriter& writer) const {
+        writer.add(CompiledTag('V', 'C', 'O', 'F'), offsetData, offsetData ? idLimit + 1 : 0);
+        writer.add(CompiledTag('V', 'C', 'F', 'L'), bitData, wordCount * 2);
+    }
+
+    /**
+     * 컴파일된 이미지의 배열을 복사 없이 사용합니다.
+     * @param blobBase 토큰 문자열 blob (이 테이블의 문자열이 앞부분에 있어야 함)
+     * @param blobLimit blob 바이트 수
+     * @return 섹션이 모두 있고 오프셋이 blob 범위 안에서 오름차순이면 true
+     */
+    bool attach(const CompiledReader& reader, const char* blobBase, size_t blobLimit) {
+        const uint32_t* offsetArray;
+        const uint64_t* bitArray;
+        size_t offsetCount, bitCount;
+        if (!reader.get(CompiledTag('V', 'C', 'O', 'F'), offsetArray, offsetCount) || offsetCount == 0) return false;
+        if (!reader.get(CompiledTag('V', 'C', 'F', 'L'), bitArray, bitCount)) return false;
+        const size_t limit = offsetCount - 1;
+        if (bitCount != (limit + 63) / 64 * 2 || offsetArray[0] != 0 || offsetArray[limit] > blobLimit) return false;
+        for (size_t i = 0; i < limit; ++i) {
+            if (offsetArray[i] > offsetArray[i + 1]) return false;
+        }
+        clear();
+        offsetData = offsetArray;
+        bitData = bitArray;
+        blobData = blobBase;
+        idLimit = limit;
+        wordCount = bitCount / 2;
+        blobSize = offsetArray[limit];
+        return true;
+    }
+
+    /**
+     * 빌드를 시작합니다. add는 ID 오름차순으로, blob에 토큰을 이어붙이는 순서대로 호출해야 합니다.
+     * @param limit 가장 큰 ID + 1
+     */
+    void beginBuild(size_t limit) {
+        clear();
+        idLimit = limit;
+        wordCount = (limit + 63) / 64;
+        offsets.reserve(limit + 1);
+        bits.assign(wordCount * 2, 0);
+    }
+
+    void add(int id, size_t length, bool special) {
+        offsets.resize(static_cast<size_t>(id), static_cast<uint32_t>(blobSize)); // 빠진 ID는 길이 0
+        offsets.push_back(static_cast<uint32_t>(blobSize));
+        blobSize += length;
+        bits[id >> 6] |= 1ull << (id & 63);
+        if (special) bits[wordCount + (id >> 6)] |= 1ull << (id & 63);
+    }
+
+    /**
+     * 빌드를 마칩니다.
+     * @param blobBase add한 토큰을 같은 순서로 이어붙인 blob (테이블이 살아 있는 동안 유지되어야 함)
+     */
+    void finishBuild(const char* blobBase) {
+        offsets.resize(idLimit + 1, static_cast<uint32_t>(blobSize));
+        offsetData = offsets.data();
+        bitData = bits.data();
+        blobData = blobBase;
+    }
+
+private:
+    std::vector<uint32_t> offsets; // ID별 blob 시작 위치 (idLimit + 1개, 컴파일된 이미지를 쓰면 비어 있음)
+    std::vector<uint64_t> bits;    // 앞 wordCount개: ID 존재 비트셋, 뒤 wordCount개: 특수 토큰 비트셋
+    const uint32_t* offsetData;    // 검색에 쓰는 배열 (위 멤버 또는 매핑된 이미지)
+    const uint64_t* bitData;
+    const char* blobData;          // ID 순서로 이어붙인 토큰 문자열 (호출한 쪽 소유)
+    size_t idLimit;
+    size_t wordCount;
+    size_t blobSize;
+
+    inline bool testBit(size_t row, uint32_t id) const {
+        return (bitData[row + (id >> 6)] >> (id & 63)) & 1;
+    }
+};
+
+#endif
@@ -0,0 +1,144 @@
+#pragma once
+#ifndef LIN_MAX_MATCH_H
+#define LIN_MAX_MATCH_H
+
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+#include "compiled_image.h"
+
+/****************************************************************
+* Class Name: LinMaxMatch
+* Description: WordPiece 선형 시간 매칭용 failure link / failure pop 테이블
+*              (Aho-Corasick 방식, "Fast WordPiece Tokenization" LinMaxMatch)
+*              상태 s에서 다음 바이트로 전이할 수 없으면 pops(s)의 토큰들을
+*              출력하고 fail(s) 상태에서 같은 바이트를 다시 시도함
+*              각 입력 바이트는 한 번만 Trie를 따라가며, 결과는 탐욕적
+*              최장 일치(greedy longest-match)와 동일함
+*              상태 번호는 검색용 Trie 엔진의 상태 번호를 그대로 사용
+****************************************************************/
+class LinMaxMatch {
+public:
+    enum : uint32_t { NONE = 0xFFFFFFFFu };
+
+    // failure pop 하나: 출력할 토큰 ID와 그 토큰이 소비하는 입력 바이트 수
+    struct Pop {
+        int32_t id;
+        uint32_t length;
+    };
+
+    struct Entry {
+        uint32_t fail;      // failure link 상태 (없으면 NONE: 탐욕 매칭으로 대체)
+        uint32_t popOffset; // pops 배열에서의 시작 위치
+        uint32_t popCount;  // failure pop 개수
+    };
+
+    LinMaxMatch(): entryData(nullptr), popData(nullptr), entrySize(0), popSize(0), rootState(NONE), prefixState(NONE) {}
+
+    // 검색용 포인터가 자기 벡터를 가리키므로 복사는 금지하고 이동만 허용
+    LinMaxMatch(const LinMaxMatch&) = delete;
+    LinMaxMatch& operator=(const LinMaxMatch&) = delete;
+    LinMaxMatch(LinMaxMatch&&) = default;
+    LinMaxMatch& operator=(LinMaxMatch&&) = default;
+
+    void clear() {
+        entries.clear();
+        entries.shrink_to_fit();
+        pops.clear();
+        pops.shrink_to_fit();
+        entryData = nullptr;
+        popData = nullptr;
+        entrySize = 0;
+        popSize = 0;
+        rootState = NONE;
+        prefixState = NONE;
+    }
+
+    // 테이블이 구성되어 있는지 여부 (WordPiece가 아니거나 "##" 노드가 없으면 비어 있음)
+    bool enabled() const { return prefixState != NONE; }
+
+    uint32_t root() const { return rootState; }
+    uint32_t prefix() const { return prefixState; } // "##" 상태
+
+    inline const Entry& entry(uint32_t state) const { return entryData[state]; }
+    inline const Pop* popsOf(const Entry& e) const { return popData + e.popOffset; }
+
+    size_t memoryUsage() const {
+        return std::max(entries.capacity(), entrySize) * sizeof(Entry) + std::max(pops.capacity(), popSize) * sizeof(Pop);
+    }
+
+    // 컴파일된 이미지에 failure link / pop 테이블을 기록합니다. (비활성이면 기록하지 않음)
+    void save(CompiledWriter& writer) const {
+        if (!enabled()) return;
+        writer.add(CompiledTag('L', 'M', 'E', 'N'), entryData, entrySize);
+        writer.add(CompiledTag('L', 'M', 'P', 'O'), popData, popSize);
+        writer.addValue(CompiledTag('L', 'M', 'R', 'T'), rootState);
+        writer.addValue(CompiledTag('L', 'M', 'P', 'F'), prefixState);
+    }
+
+    /**
+     * 컴파일된 이미지의 테이블을 복사 없이 사용합니다. 섹션이 없으면 비활성 상태가 됩니다.
+     * @param stateSpace 검색용 Trie의 상태 번호 범위 (테이블 크기 검증용)
+     * @return 섹션이 없거나 올바르면 true
+     */
+    bool attach(const CompiledReader& reader, size_t stateSpace) {
+        clear();
+        const Entry* entryArray;
+        const Pop* popArray;
+        uint32_t root, prefix;
+        size_t count, pcount;
+        if (!reader.getValue(CompiledTag('L', 'M', 'P', 'F'), prefix)) return true;
+        if (!reader.getValue(CompiledTag('L', 'M', 'R', 'T'), root) || root >= stateSpace || prefix >= stateSpace) return false;
+        if (!reader.get(CompiledTag('L', 'M', 'E', 'N'), entryArray, count) || count != stateSpace) return false;
+        if (!reader.get(CompiledTag('L', 'M', 'P', 'O'), popArray, pcount)) return false;
+        entryData = entryArray;
+        popData = popArray;
+        entrySize = count;
+        popSize = pcount;
+        rootState = root;
+        prefixState = prefix;
+        return true;
+    }
+
+    /**
+     * 빌드를 시작합니다.
+     * @param stateSpace 검색용 Trie의 상태 번호 범위
+     * @param root 루트 상태
+     * @param prefix 서브워드 접두사("##")까지 이동한 상태
+     */
+    void beginBuild(size_t stateSpace, uint32_t root, uint32_t prefix) {
+        clear();
+        Entry empty = { NONE, 0, 0 };
+        entries.assign(stateSpace, empty);
+        entryData = entries.data();
+        entrySize = entries.size();
+        rootState = root;
+        prefixState = prefix;
+    }
+
+    void setEntry(uint32_t state, uint32_t fail, const Pop* statePops, size_t count) {
+        Entry& e = entries[state];
+        e.fail = fail;
+        e.popOffset = static_cast<uint32_t>(pops.size());
+        e.popCount = static_cast<uint32_t>(count);
+        pops.insert(pops.end(), statePops, statePops + count);
+    }
+
+    void finishBuild() {
+        pops.shrink_to_fit();
+        popData = pops.data();
+        popSize = pops.size();
+    }
+
+private:
+    std::vector<Entry> entries; // 상태별 failure link (컴파일된 이미지를 쓰면 비어 있음)
+    std::vector<Pop> pops;      // 모든 상태의 failure pop을 이어붙인 배열
+    const Entry* entryData;     // 검색에 쓰는 배열 (위 벡터 또는 매핑된 이미지)
+    const Pop* popData;
+    size_t entrySize;
+    size_t popSize;
+    uint32_t rootState;
+    uint32_t prefixState;
+};
+
+#endif
@@ -0,0 +1,121 @@
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "nemo_tokenizer.h"
+
+/****************************************************************
+* Description: 빌드 시 tokenizer.json을 C++ 소스로 변환하는 생성기 (nemo_embed)
+*              토크나이저를 로드하여 컴파일된 이미지(saveCompiled 형식)를 만들고
+*              64바이트 정렬된 정적 배열로 출력
+*              생성된 소스를 링크하면 NemoTokenizer::loadEmbedded가 이 배열을
+*              복사 없이 가리키므로 시작 시 파일 입출력과 파싱이 없음
+*              형식: string - 문자열 리터럴 (GCC/Clang에서 큰 이미지도 빠르게 컴파일)
+*                    array  - 8바이트 정수 배열 (문자열 리터럴 길이 제한이 있는 MSVC용,
+*                             이미지는 바이트 순서가 같은 환경에서만 열리므로 빌드 환경의 바이트 순서로 묶음)
+*
+*              사용법: nemo_embed <tokenizer.json> <출력 .cpp> [double_array|frozen|dense|radix] [string|array]
+****************************************************************/
+
+static bool parseEngine(const std::string& name, TrieEngine& engine) {
+    if (name == "double_array") engine = TrieEngine::DoubleArray;
+    else if (name == "frozen") engine = TrieEngine::Frozen;
+    else if (name == "dense") engine = TrieEngine::Dense;
+    else if (name == "radix") engine = TrieEngine::Radix;
+    else return false;
+    return true;
+}
+
+static bool readFile(const std::string& path, std::vector<unsigned char>& data) {
+    FILE* fp = std::fopen(path.c_str(), "rb");
+    if (!fp) return false;
+    unsigned char buffer[1 << 16];
+    size_t n;
+    while ((n = std::fread(buffer, 1, sizeof(buffer), fp)) > 0) data.insert(data.end(), buffer, buffer + n);
+    const bool ok = !std::ferror(fp);
+    std::fclose(fp);
+    return ok;
+}
+
+/**
+ * 이미지를 정적 배열 소스로 기록합니다.
+ * @param path 출력 .cpp 경로
+ * @param image 컴파일된 이미지
+ * @param source 원본 tokenizer.json 경로 (주석용)
+ * @param engine 엔진 이름 (주석용)
+ * @param words true면 8바이트 정수 배열, false면 문자열 리터럴
+ * @return 성공 여부
+ */
+static bool writeSource(const std::string& path, const std::vector<unsigned char>& image,
+                        const std::string& source, const std::string& engine, bool words) {
+    FILE* fp = std::fopen(path.c_str(), "w");
+    if (!fp) return false;
+    std::fprintf(fp, "// 자동 생성 파일 (nemo_embed) - 직접 수정하지 마세요\n");
+    std::fprintf(fp, "// 원본: %s, 엔진: %s, %zu 바이트\n\n", source.c_str(), engine.c_str(), image.size());
+    std::fprintf(fp, "#include <cstddef>\n#include <cstdint>\n\n");
+    if (words) {
+        std::fprintf(fp, "alignas(64) static const uint64_t nemoEmbeddedBytes[] = {\n");
+        const size_t wordCount = (image.size() + 7) / 8; // 남는 바이트는 0으로 채움 (이미지 크기는 64의 배수)
+        for (size_t i = 0; i < wordCount; ++i) {
+            uint64_t word = 0;
+            std::memcpy(&word, image.data() + i * 8, std::min<size_t>(8, image.size() - i * 8));
+            std::fprintf(fp, "0x%llxu,", static_cast<unsigned long long>(word));
+            if (i % 8 == 7) std::fputc('\n', fp);
+        }
+        std::fprintf(fp, "\n};\n\n");
+    } else {
+        std::fprintf(fp, "alignas(64) static const char nemoEmbeddedBytes[] =\n");
+        for (size_t i = 0; i < image.size(); ++i) {
+            if (i % 64 == 0) std::fputc('"', fp);
+            std::fprintf(fp, "\\x%02x", static_cast<unsigned>(image[i]));
+            if (i % 64 == 63 || i + 1 == image.size()) std::fputs("\"\n", fp);
+        }
+        std::fprintf(fp, ";\n\n");
+    }
+    std::fprintf(fp, "const unsigned char* nemoEmbeddedImageData() {\n");
+    std::fprintf(fp, "    return reinterpret_cast<const unsigned char*>(nemoEmbeddedBytes);\n}\n\n");
+    std::fprintf(fp, "size_t nemoEmbeddedImageSize() {\n    return %zuu;\n}\n", image.size());
+    return std::fclose(fp) == 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3 || argc > 5) {
+        std::fprintf(stderr, "usage: nemo_embed <tokenizer.json> <output.cpp> [double_array|frozen|dense|radix] [string|array]\n");
+        return 2;
+    }
+    const std::string input = argv[1];
+    const std::string output = argv[2];
+    const std::string engineName = (argc >= 4) ? argv[3] : "double_array";
+    const std::string format = (argc >= 5) ? argv[4] : "string";
+
+    TrieEngine engine;
+    if (!parseEngine(engineName, engine)) {
+        std::fprintf(stderr, "Error: 알 수 없는 Trie 엔진: %s\n", engineName.c_str());
+        return 2;
+    }
+    if (format != "string" && format != "array") {
+        std::fprintf(stderr, "Error: 알 수 없는 출력 형식: %s\n", format.c_str());
+        return 2;
+    }
+
+    // 컴파일된 이미지를 임시 파일로 저장한 뒤 다시 읽어 배열로 출력
+    NemoTokenizer tokenizer;
+    tokenizer.setTrieEngine(engine);
+    tokenizer.loadTokenizer(input);
+    const std::string imagePath = output + ".image";
+    std::vector<unsigned char> image;
+    const bool saved = tokenizer.saveCompiled(imagePath) && readFile(imagePath, image);
+    std::remove(imagePath.c_str());
+    if (!saved) {
+        std::fprintf(stderr, "Error: 컴파일된 이미지를 만들 수 없습니다: %s\n", input.c_str());
+        return 1;
+    }
+
+    if (!writeSource(output, image, input, engineName, format == "array")) {
+        std::fprintf(stderr, "Error: 소스 파일을 쓸 수 없습니다: %s\n", output.c_str());
+        std::remove(output.c_str());
+        return 1;
+    }
+    return 0;
+}
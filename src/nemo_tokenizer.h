@@ -21,9 +21,20 @@
 #include <functional>
 #include <thread>
 #include <iterator>
+#include <memory>
+#include <mutex>
 #include <omp.h>  // OpenMP 헤더 추가
 #include <xsimd/xsimd.hpp>
 #include "json.hpp"
+#include "double_array_trie.h"
+#include "frozen_trie.h"
+#include "byte_class_trie.h"
+#include "radix_trie.h"
+#include "lin_max_match.h"
+#include "first_level_table.h"
+#include "id_token_table.h"
+#include "token_id_hash.h"
+#include "compiled_image.h"
 
 // JSON 네임스페이스 명시적 선언
 using nlohmann::json;
@@ -32,9 +43,6 @@ using nlohmann::json;
 #if defined(_MSC_VER)
 #include <intrin.h>
 
-// Trie 검색 방식 선택 : 압축방식 Trie(Radix Trie)가 필요하면 적용을 고려해보자.
-#define TRIE_SEARCH_TYPE 1 // 0: Low memory,low speed  1: High memory,high speed 
-
 inline unsigned int CountTrailingZeros64(uint64_t x) {
     unsigned long index;
 #if defined(_WIN64)
@@ -60,67 +68,159 @@ inline unsigned int CountTrailingZeros64(uint64_t x) {
 }
 #endif
 
+// 검색용 Trie 엔진 종류 (실행 중 선택, 기존 컴파일 타임 TRIE_SEARCH_TYPE 대체)
+enum class TrieEngine {
+    DoubleArray, // base/check 배열 (기본값, 메모리 적음)
+    Frozen,      // BFS 순서로 재배치한 인덱스 아레나
+    Dense,       // 바이트 클래스 단위 전이 테이블 (메모리 많음, 속도 빠름)
+    Radix        // 단일 자식 체인을 간선 레이블로 압축한 Radix Trie (WordPiece 선형 매칭 미사용)
+};
+
+// loadShared 결과
+enum class SharedLoad {
+    Failed,  // tokenizer.json을 찾을 수 없거나 올바르지 않음 (기존 상태 유지)
+    Private, // 공유 이미지를 저장하거나 매핑할 수 없어 프로세스 전용 사본을 사용
+    Shared   // 공유 이미지를 매핑하여 사용
+};
+
+// batch_encode 결과 (CSR 형식): 문서 i의 토큰 ID는 ids[offsets[i]] ~ ids[offsets[i + 1] - 1]
+struct EncodedBatch {
+    std::vector<int32_t> ids;     // 모든 문서의 토큰 ID를 순서대로 이어 붙인 배열
+    std::vector<int64_t> offsets; // 문서 수 + 1개, offsets[0] = 0, 마지막 값 = ids.size()
+};
+
+// batch_encode_padded 길이 맞춤 옵션
+struct PaddingOptions {
+    size_t maxLength = 0;        // 최대 길이 (0이면 제한 없음)
+    bool truncation = false;     // maxLength보다 긴 문서를 자를지 여부 (시작/종료 토큰은 유지)
+    bool padToMaxLength = false; // true면 maxLength까지, false면 가장 긴 문서 길이까지 채움
+    bool padLeft = false;        // true면 왼쪽, false면 오른쪽에 채움
+    size_t padToMultipleOf = 0;  // 길이를 이 값의 배수로 올림 (0이면 사용 안 함)
+    int padId = -1;              // 채움 토큰 ID (-1이면 padTokenId())
+};
+
+// batch_encode_padded 결과: [batchSize, sequenceLength] 행 우선 배열 3개
+struct PaddedBatch {
+    size_t batchSize = 0;
+    size_t sequenceLength = 0;
+    std::vector<int32_t> inputIds;      // 토큰 ID, 남는 자리는 채움 토큰 ID
+    std::vector<int32_t> attentionMask; // 토큰 자리는 1, 채운 자리는 0
+    std::vector<int32_t> tokenTypeIds;  // 단일 문장이므로 모두 0
+};
+
 /****************************************************************
 * Class Name: NemoTokenizer
 * Description: SentencePiece & WordPiece 자동 선택
 *              Trie 구조를 사용하여 검색 최적화 
+*              (로드 시 TrieNode로 구성한 뒤 Double-Array Trie로 변환)
 ****************************************************************/
 class NemoTokenizer {
 private:
+    // 빌드용 Trie 노드 (자식은 레이블 오름차순으로 정렬된 형제 연결 리스트)
     struct TrieNode {
+        uint32_t firstChild;  // 첫 번째 자식 인덱스 (0이면 없음, 0번은 항상 루트)
+        uint32_t nextSibling; // 다음 형제 인덱스 (0이면 없음)
+        int id;
+        unsigned char label;  // 부모에서 이 노드로 오는 바이트
         bool isEnd;
         bool isSpecial;  // 특수 토큰 여부 플래그 추가
-        int id;
-#if TRIE_SEARCH_TYPE == 1 // 속도 향상을 위한 방법
-        TrieNode* children[256];
-#else
-        std::unordered_map<char, TrieNode*> children;
-#endif
 
-        TrieNode(): isEnd(false), isSpecial(false), id(-1) { }
+        TrieNode(): firstChild(0), nextSibling(0), id(-1), label(0), isEnd(false), isSpecial(false) { }
     };
 
+    // 인덱스 기반 노드 풀
+    // 자식은 포인터 대신 32비트 인덱스로 참조하므로 벡터가 커지며 재할당되어도 안전함
     struct MemoryPool {
         std::vector<TrieNode> pool;
-        size_t index;
 
-        explicit MemoryPool(size_t initialSize): index(0) {
-    		pool.resize(initialSize); // resize로 미리 공간 확보만 함 (초기화 없음)
-		}
+        explicit MemoryPool(size_t initialSize) {
+            pool.reserve(initialSize); // 공간만 미리 확보
+        }
 
-        TrieNode* allocate() {
-            if (index >= pool.size()) {
-                size_t newSize = pool.size() * 2;
-                for (size_t i = pool.size(); i < newSize; ++i) {
-                    pool.resize(newSize); // 확장도 resize만으로 공간 확보
-                }
+        uint32_t allocate() {
+            pool.emplace_back();
+            return static_cast<uint32_t>(pool.size() - 1);
+        }
+
+        void resize(size_t size) { pool.resize(size); }
+
+        TrieNode& operator[](uint32_t index) { return pool[index]; }
+        const TrieNode& operator[](uint32_t index) const { return pool[index]; }
+        size_t size() const { return pool.size(); }
+
+        // ch 레이블을 가진 자식 인덱스 (없으면 0)
+        uint32_t child(uint32_t node, unsigned char ch) const {
+            uint32_t c = pool[node].firstChild;
+            while (c && pool[c].label < ch) c = pool[c].nextSibling;
+            return (c && pool[c].label == ch) ? c : 0;
+        }
+
+        // 자식을 레이블 오름차순으로 방문 f(label, index)
+        template <class F>
+        void forEachChild(uint32_t node, F f) const {
+            for (uint32_t c = pool[node].firstChild; c; c = pool[c].nextSibling) {
+                f(pool[c].label, c);
             }
-            TrieNode* node = &pool[index++];
-        
-            // node가 처음 사용될 때만 명시적으로 초기화
-            node->isEnd = false;
-            node->isSpecial = false;  // 특수 토큰 초기화 추가
-            node->id = -1;
-#if TRIE_SEARCH_TYPE == 1
-            memset(node->children, 0, sizeof(node->children));
-#endif
-        
-            return node;
         }
     };
 
-    // 토큰 정보를 포함하는 구조체
-    struct TokenInfo {
-        std::string token;
-        bool isSpecial;
-        
-        TokenInfo(const std::string& t = "", bool special = false)
-            : token(t), isSpecial(special) {}
+    // 여러 단어를 번갈아 매칭할 때 동시에 진행하는 단어 수
+    enum { INTERLEAVE_LANES = 8 };
+
+    // 번갈아 매칭 중인 단어 하나의 진행 상태 (탐욕적 최장 일치와 동일한 순서로 진행)
+    struct Lane {
+        const char* word;
+        size_t length;
+        size_t position;   // 현재 조각의 시작 위치
+        size_t scan;       // 조각 시작부터 따라간 바이트 수
+        uint32_t state;
+        int matchedId;
+        int matchedLen;
+        bool wordStart;    // SentencePiece 단어 첫 조각 ("▁" 상태에서 시작)
+        bool continuation; // WordPiece 이어지는 조각 ("##" 상태에서 시작)
+    };
+
+    // 단어 순서대로 sink에 전달하기 위해 모아두는 출력 (id가 -1이면 UNK)
+    struct PieceEvent {
+        int id;
+        uint32_t offset;
+        uint32_t length;
+        bool withPrefix;
+    };
+
+    // 컴파일된 이미지의 토크나이저 메타데이터 ('META' 섹션)
+    struct CompiledMeta {
+        uint32_t engine;             // TrieEngine 값
+        int32_t unkId;
+        int32_t startId;
+        int32_t endId;
+        uint64_t maxTokenLength;
+        uint32_t wordStartState;
+        int32_t wordStartPrefixId;
+        uint32_t continuationState;
+        uint32_t flags;              // bit0: hasWordStartState, bit1: hasContinuationState
+        uint32_t stringLength[5];    // 'STRS' 섹션의 decoderType, unkToken, startToken, endToken, subwordPrefix 길이
+        uint32_t reserved;
     };
 
     // 멤버 변수
-    MemoryPool* nodePool;
-    TrieNode* root;
+    TrieEngine trieEngine;   // 지금 로드된 검색용 Trie 엔진 (로드/연결할 때만 바뀜)
+    TrieEngine engineSetting; // 다음 loadTokenizer에서 만들 엔진 (setTrieEngine)
+    bool interleaved;        // 여러 단어를 번갈아 매칭하여 메모리 지연을 겹칠지 여부 (로드/연결할 때만 바뀜)
+    bool interleavedSetting; // 다음 로드부터 적용할 interleaved 값 (setInterleavedMatching)
+    bool decodeTables;       // 디코드용 ID/토큰 맵을 만들 수 있게 원본을 보관할지 여부 (loadTokenizer 시점에 적용)
+    DoubleArrayTrie trie;    // TrieEngine::DoubleArray 일 때 사용
+    FrozenTrie frozenTrie;   // TrieEngine::Frozen 일 때 사용
+    ByteClassTrie denseTrie; // TrieEngine::Dense 일 때 사용
+    RadixTrie radixTrie;     // TrieEngine::Radix 일 때 사용
+    LinMaxMatch linMaxMatch; // WordPiece 선형 매칭용 failure link (활성 엔진의 상태 번호 기준)
+    uint32_t wordStartState;     // SentencePiece: 루트에서 subwordPrefix("▁")를 따라간 상태
+    int wordStartPrefixId;       // SentencePiece: subwordPrefix 자체가 토큰이면 그 ID, 아니면 -1
+    bool hasWordStartState;      // wordStartState를 바로 사용할 수 있는지 여부
+    uint32_t continuationState;  // WordPiece: 루트에서 "##"를 따라간 상태
+    bool hasContinuationState;   // "##" 경로가 Trie에 있는지 여부
+    FirstLevelTable rootTable;   // 루트에서 시작하는 2바이트 직접 테이블
+    FirstLevelTable startTable;  // wordStartState(SentencePiece) 또는 continuationState(WordPiece)에서 시작하는 2바이트 직접 테이블
     std::string decoderType; // "Metaspace" 면 SentencePiece, "WordPiece" 면 WordPiece
     std::string unkToken;    // UNK 토큰
     std::string startToken;  // 시작 토큰
@@ -129,12 +229,21 @@ private:
     int startId;             // 시작 토큰 ID
     int endId;               // 종료 토큰 ID
     std::string subwordPrefix; // SentencePiece의 replacement 값 또는 WordPiece의 prefix 값
+    size_t maxTokenLength;     // Trie에 넣은 가장 긴 토큰의 바이트 수 (최장 일치 탐색 길이 상한)
+    std::shared_ptr<const void> compiledImage; // loadCompiled로 매핑한 이미지 또는 loadEmbedded의 링크된 배열 (Trie 배열과 어휘 테이블이 이 메모리를 직접 가리킴)
     
-    // ID에서 토큰 정보로의 빠른 변환을 위한 맵 (isSpecial 정보 포함)
-    std::unordered_map<int, TokenInfo> idToTokenMap;
+    // ID -> 토큰 평면 테이블 (특수 토큰 비트셋 포함, 매핑된 이미지를 직접 가리킬 수도 있음)
+    // 인코딩만 하는 경우를 위해 처음 디코드/변환할 때 decodeSource로 만듦 (ensureDecodeTables)
+    mutable IdTokenTable idTable;
     
-    // 토큰에서 ID로의 빠른 변환을 위한 맵
-    std::unordered_map<std::string, int> tokenToIdMap;
+    // 토큰 -> ID 최소 완전 해시 (특수 토큰 여부 포함, idTable과 같은 시점에 만듦)
+    mutable TokenIdHash tokenHash;
+
+    // 위 두 테이블이 가리키는 토큰 문자열 (ID 순서 토큰 뒤에 ID 테이블에 없는 토큰, 매핑된 이미지를 쓰면 비어 있음)
+    mutable std::string vocabBlob;
+
+    // 위 테이블들을 한 번만 만들기 위한 플래그 (로드할 때마다 새로 만듦, 없으면 만들 원본이 없음)
+    mutable std::unique_ptr<std::once_flag> decodeTablesOnce;
 
     // 특수 문자 룩업 테이블 추가
     bool isSpecialChar[256];
@@ -181,20 +290,19 @@ private:
     }
 
     // 내부 함수
-    std::pair<std::string, int> searchLastMatchedToken(const std::string& word, bool isSubword) const {
-        TrieNode* current = root;
+    template <class Trie>
+    std::pair<std::string, int> searchLastMatchedToken(const Trie& t, const std::string& word, bool isSubword) const {
+        uint32_t current = t.root();
         int lastMatchedId = -1;
         int lastMatchedPos = -1;
     
         const char* ptr = word.c_str();
         for (size_t i = 0; *ptr; ++i, ++ptr) {
             unsigned char ch = static_cast<unsigned char>(*ptr);
-            if (!current->children[ch]) break;
-    
-            current = current->children[ch];
+            if (!t.next(current, ch)) break;
     
-            if (current->isEnd) {
-                lastMatchedId = current->id;
+            if (t.value(current) != -1) {
+                lastMatchedId = t.value(current);
                 lastMatchedPos = i;
             }
         }
@@ -206,235 +314,1844 @@ private:
 
     // 토큰 문자열이 특수 토큰인지 확인하는 함수
     bool isSpecialToken(const std::string& token) const {
-        // Trie 구조를 통해 해당 토큰이 존재하는지 확인
-        TrieNode* current = root;
-        for (unsigned char ch : token) {
-            if (!current->children[ch]) return false;
-            current = current->children[ch];
+        // 어휘 테이블이 있으면 해시 조회 한 번으로 확인
+        if (hasVocabTables()) {
+            ensureDecodeTables();
+            return tokenHash.isSpecial(token.data(), token.size());
         }
-        
-        // 토큰이 존재하고 특수 토큰으로 표시되었는지 확인
-        return current->isEnd && current->isSpecial;
+
+        // Trie 구조를 통해 해당 토큰이 존재하는지 확인
+        bool result = false;
+        withTrie([&](const auto& t) {
+            uint32_t current;
+            // 토큰이 존재하고 특수 토큰으로 표시되었는지 확인
+            result = findState(t, token, current) && t.value(current) != -1 && t.isSpecial(current);
+        });
+        return result;
     }
 
-    // ID가 특수 토큰 ID인지 확인하는 함수
+    // ID가 특수 토큰 ID인지 확인하는 함수 (특수 토큰 비트셋)
     bool isSpecialTokenId(int id) const {
-        auto it = idToTokenMap.find(id);
-        return (it != idToTokenMap.end() && it->second.isSpecial);
+        ensureDecodeTables();
+        return idTable.isSpecial(id);
+    }
+
+    // 토큰 문자열에 해당하는 ID를 찾습니다. (토큰 -> ID 해시)
+    bool findId(const std::string& token, int& id) const {
+        ensureDecodeTables();
+        return tokenHash.findId(token.data(), token.size(), id);
+    }
+
+    // 어휘 테이블이 있거나 만들 수 있는지 여부 (setDecodeTables(false)로 로드했으면 false)
+    bool hasVocabTables() const {
+        return decodeTablesOnce || compiledImage;
+    }
+
+    // 바이트 사전순 비교 (음수/0/양수)
+    static int compareBytes(const char* a, size_t aLength, const char* b, size_t bLength) {
+        const int c = std::memcmp(a, b, std::min(aLength, bLength));
+        if (c) return c;
+        return (aLength < bLength) ? -1 : (aLength > bLength ? 1 : 0);
+    }
+
+    // 정렬된 토큰 범위를 병렬로 Trie에 넣을 때 한 작업이 맡는 최소 토큰 수
+    enum { BULK_TASK_MIN_TOKENS = 256 };
+
+    // 빌드할 토큰 목록 (삽입 순서를 유지하며 같은 토큰은 나중 항목이 우선)
+    struct TokenList {
+        struct Entry {
+            uint32_t offset; // blob 내 시작 위치
+            uint32_t length;
+            int id;
+            bool isSpecial;
+        };
+
+        std::string blob;
+        std::vector<Entry> entries;
+
+        void add(const std::string& token, int id, bool isSpecial) {
+            Entry e = { static_cast<uint32_t>(blob.size()), static_cast<uint32_t>(token.size()), id, isSpecial };
+            blob += token;
+            entries.push_back(e);
+        }
+
+        const unsigned char* text(const Entry& e) const {
+            return reinterpret_cast<const unsigned char*>(blob.data()) + e.offset;
+        }
+    };
+
+    // 디코드용 테이블의 원본: loadTokenizer가 읽은 순서 그대로의 토큰 목록 (테이블을 만들면 해제)
+    mutable TokenList decodeSource;
+
+    // 처음 호출될 때 decodeSource로 ID 테이블과 토큰 해시를 만듭니다. (여러 스레드에서 동시에 호출해도 안전)
+    void ensureDecodeTables() const {
+        if (decodeTablesOnce) {
+            std::call_once(*decodeTablesOnce, [this]() { buildDecodeTables(); });
+        }
+    }
+
+    // ID 테이블에 넣는 ID의 상한 (이 이상이거나 음수인 ID는 ID -> 토큰 변환에서 제외)
+    static size_t decodeIdCap(size_t entryCount) {
+        return std::max<size_t>(entryCount * 4, 1u << 20);
+    }
+
+    /**
+     * decodeSource를 읽은 순서대로 적용해 ID 테이블과 토큰 해시를 만듭니다.
+     * 기본 어휘는 그대로 등록하고, 특수 토큰은 같은 ID가 이미 있으면 특수 토큰으로 표시만 하고
+     * 없으면 새로 등록합니다. (tokenizer.json의 added_tokens, 시작/종료/UNK 토큰 순서)
+     * ID 테이블은 ID로 바로 색인하므로 음수 ID와 어휘 크기에 비해 지나치게 큰 ID는 넣지 않습니다.
+     * 토큰 해시의 특수 토큰 표시는 Trie와 같게 같은 토큰의 마지막 항목을 따릅니다.
+     */
+    void buildDecodeTables() const {
+        const std::vector<TokenList::Entry>& entries = decodeSource.entries;
+        const size_t idCap = decodeIdCap(entries.size());
+        size_t idLimit = 0;
+        for (const TokenList::Entry& e : entries) {
+            if (e.id >= 0 && static_cast<size_t>(e.id) < idCap) idLimit = std::max(idLimit, static_cast<size_t>(e.id) + 1);
+        }
+
+        // ID별로 최종 토큰(목록 내 위치)과 특수 토큰 여부 결정
+        std::vector<int32_t> chosen(idLimit, -1);
+        std::vector<bool> special(idLimit, false);
+        std::vector<bool> markOnly(entries.size(), false); // 특수 토큰 표시만 하고 토큰 -> ID 변환에는 쓰지 않는 항목
+        for (size_t i = 0; i < entries.size(); ++i) {
+            const TokenList::Entry& e = entries[i];
+            const bool indexed = e.id >= 0 && static_cast<size_t>(e.id) < idLimit;
+            if (e.isSpecial && indexed && chosen[e.id] != -1) {
+                special[e.id] = true;
+                markOnly[i] = true;
+                continue;
+            }
+            if (indexed) {
+                // 기본 어휘끼리 ID가 겹치면 키 사전순으로 나중인 토큰 (DOM 객체 순회 순서와 동일하게)
+                const int32_t prev = chosen[e.id];
+                if (e.isSpecial || prev == -1
+                    || compareBytes(decodeSource.blob.data() + entries[prev].offset, entries[prev].length,
+                                    decodeSource.blob.data() + e.offset, e.length) < 0) {
+                    chosen[e.id] = static_cast<int32_t>(i);
+                    special[e.id] = e.isSpecial;
+                }
+            }
+        }
+
+        // 같은 토큰끼리 모아 토큰별로 ID(표시만 하는 항목 제외 마지막 항목)와 특수 토큰 여부(마지막 항목) 결정
+        // (문자열 해시와 목록 내 위치로 정렬하고, 해시가 같은 구간만 바이트 순으로 안정 정렬)
+        const char* source = decodeSource.blob.data();
+        std::vector<std::pair<uint64_t, uint32_t>> order(entries.size());
+        for (size_t i = 0; i < order.size(); ++i) {
+            order[i] = std::make_pair(TokenIdHash::hashBytes(source + entries[i].offset, entries[i].length, 0), static_cast<uint32_t>(i));
+        }
+        parallelStableSort(order, std::less<std::pair<uint64_t, uint32_t>>());
+        for (size_t lo = 0, hi; lo < order.size(); lo = hi) {
+            for (hi = lo + 1; hi < order.size() && order[hi].first == order[lo].first; ++hi) {}
+            if (hi - lo > 1) {
+                std::stable_sort(order.begin() + lo, order.begin() + hi,
+                    [&entries, source](const std::pair<uint64_t, uint32_t>& a, const std::pair<uint64_t, uint32_t>& b) {
+                        const TokenList::Entry& x = entries[a.second];
+                        const TokenList::Entry& y = entries[b.second];
+                        return compareBytes(source + x.offset, x.length, source + y.offset, y.length) < 0;
+                    });
+            }
+        }
+        std::vector<TokenIdHash::Key> keys;
+        keys.reserve(order.size());
+        for (size_t lo = 0, hi; lo < order.size(); lo = hi) {
+            const TokenList::Entry& first = entries[order[lo].second];
+            for (hi = lo + 1; hi < order.size(); ++hi) {
+                const TokenList::Entry& e = entries[order[hi].second];
+                if (e.length != first.length || std::memcmp(source + e.offset, source + first.offset, e.length) != 0) break;
+            }
+            const TokenList::Entry& last = entries[order[hi - 1].second];
+            TokenIdHash::Key key = { first.offset, first.length, -1, 0 };
+            if (last.isSpecial && last.id != -1) key.flags |= TokenIdHash::FLAG_SPECIAL;
+            for (size_t k = hi; k-- > lo;) {
+                if (!markOnly[order[k].second]) {
+                    key.id = entries[order[k].second].id;
+                    key.flags |= TokenIdHash::FLAG_ID;
+                    break;
+                }
+            }
+            if (key.flags) keys.push_back(key);
+        }
+        std::vector<std::pair<uint64_t, uint32_t>>().swap(order);
+
+        // ID 테이블에 같은 토큰이 있는 키는 그 문자열을 공유하고, 없는 키만 blob 뒤에 추가
+        auto sharesIdToken = [&](const TokenIdHash::Key& key) {
+            if (!(key.flags & TokenIdHash::FLAG_ID) || key.id < 0 || static_cast<size_t>(key.id) >= idLimit || chosen[key.id] == -1) return false;
+            const TokenList::Entry& e = entries[chosen[key.id]];
+            return e.length == key.length && std::memcmp(source + e.offset, source + key.offset, key.length) == 0;
+        };
+        size_t blobBytes = 0;
+        for (size_t id = 0; id < idLimit; ++id) {
+            if (chosen[id] != -1) blobBytes += entries[chosen[id]].length;
+        }
+        for (const TokenIdHash::Key& key : keys) {
+            if (!sharesIdToken(key)) blobBytes += key.length;
+        }
+
+        // blob: ID 순서 토큰 + 추가 토큰 (한 번에 예약하므로 재할당 없이 ID 테이블이 바로 가리킬 수 있음)
+        vocabBlob.clear();
+        vocabBlob.shrink_to_fit();
+        vocabBlob.reserve(blobBytes);
+        idTable.beginBuild(idLimit);
+        for (size_t id = 0; id < idLimit; ++id) {
+            if (chosen[id] == -1) continue;
+            const TokenList::Entry& e = entries[chosen[id]];
+            idTable.add(static_cast<int>(id), e.length, special[id]);
+            vocabBlob.append(source + e.offset, e.length);
+        }
+        idTable.finishBuild(vocabBlob.data());
+        for (TokenIdHash::Key& key : keys) {
+            if (sharesIdToken(key)) {
+                key.offset = idTable.offset(key.id);
+            } else {
+                const uint32_t offset = static_cast<uint32_t>(vocabBlob.size());
+                vocabBlob.append(source + key.offset, key.length);
+                key.offset = offset;
+            }
+        }
+        if (!tokenHash.build(keys.data(), keys.size(), vocabBlob.data(), vocabBlob.size())) {
+            std::cerr << "Error: 토큰 -> ID 해시를 만들 수 없습니다.\n";
+        }
+        decodeSource = TokenList();
+    }
+
+    // 정렬된 토큰 범위 [lo, hi) 하나를 병렬로 만드는 작업 (범위의 모든 토큰은 node까지의 depth바이트 접두사를 공유)
+    struct BulkTask {
+        uint32_t lo;
+        uint32_t hi;
+        uint32_t depth;
+        uint32_t node;      // 이 범위의 부모 노드 (풀 인덱스)
+        uint32_t base;      // 작업이 만든 노드를 풀에 이어붙일 시작 위치
+        std::vector<TrieNode> nodes; // 작업 지역 노드 (0번은 node를 대신하며 1번부터 실제 노드)
+    };
+
+    /**
+     * 벡터를 스레드 수만큼 나누어 병렬로 안정 정렬한 뒤 짝지어 병합합니다.
+     */
+    template <class T, class Compare>
+    static void parallelStableSort(std::vector<T>& v, Compare comp) {
+        const int chunks = std::max(1, std::min(omp_get_max_threads(), static_cast<int>(v.size() / 4096)));
+        if (chunks == 1) {
+            std::stable_sort(v.begin(), v.end(), comp);
+            return;
+        }
+
+        std::vector<size_t> bounds(chunks + 1);
+        for (int i = 0; i <= chunks; ++i) bounds[i] = v.size() * i / chunks;
+
+        #pragma omp parallel for schedule(static, 1)
+        for (int i = 0; i < chunks; ++i) {
+            std::stable_sort(v.begin() + bounds[i], v.begin() + bounds[i + 1], comp);
+        }
+        for (int width = 1; width < chunks; width *= 2) {
+            #pragma omp parallel for schedule(static, 1)
+            for (int i = 0; i < chunks; i += 2 * width) {
+                if (i + width < chunks) {
+                    std::inplace_merge(v.begin() + bounds[i], v.begin() + bounds[i + width],
+                                       v.begin() + bounds[std::min(i + 2 * width, chunks)], comp);
+                }
+            }
+        }
+    }
+
+    /**
+     * 토큰 목록으로 빌드용 TrieNode 트리를 한 번에 구성합니다. (0번 노드가 루트)
+     * 토큰을 사전순으로 정렬한 뒤 공통 접두사가 같은 범위로 나누어 하위 트리를 OpenMP로
+     * 병렬 구성하고, 각 하위 트리를 DFS 순서 그대로 풀에 이어붙여 루트 아래에 연결합니다.
+     * 토큰이 몰린 접두사("▁" 등)는 범위가 충분히 작아질 때까지 직렬로 한 단계씩 더 나눕니다.
+     * @param list 삽입 순서의 토큰 목록 (정렬됨)
+     * @param pool 루트만 있는 빌드용 풀
+     */
+    void buildTokenTrie(TokenList& list, MemoryPool& pool) {
+        std::vector<TokenList::Entry>& entries = list.entries;
+        for (const auto& e : entries) maxTokenLength = std::max<size_t>(maxTokenLength, e.length);
+
+        // 바이트 사전순 안정 정렬 후 같은 토큰은 마지막 항목만 남김 (순차 삽입에서 나중 값이 덮어쓰던 것과 동일)
+        parallelStableSort(entries, [&list](const TokenList::Entry& a, const TokenList::Entry& b) {
+            const int c = std::memcmp(list.text(a), list.text(b), std::min(a.length, b.length));
+            return c ? c < 0 : a.length < b.length;
+        });
+        size_t count = 0;
+        for (size_t i = 0; i < entries.size(); ++i) {
+            if (count && entries[count - 1].length == entries[i].length
+                && std::memcmp(list.text(entries[count - 1]), list.text(entries[i]), entries[i].length) == 0) {
+                entries[count - 1] = entries[i];
+            } else {
+                entries[count++] = entries[i];
+            }
+        }
+        entries.resize(count);
+
+        // 큰 범위는 직렬로 나누고 작은 범위는 병렬 작업으로 모음
+        const size_t threshold = std::max<size_t>(BULK_TASK_MIN_TOKENS, count / (static_cast<size_t>(omp_get_max_threads()) * 16));
+        std::vector<BulkTask> tasks;
+        splitTokenRange(list, pool, 0, static_cast<uint32_t>(count), 0, 0, threshold, tasks);
+
+        #pragma omp parallel for schedule(dynamic, 1)
+        for (int i = 0; i < static_cast<int>(tasks.size()); ++i) {
+            buildTokenRange(list, tasks[i]);
+        }
+
+        // 작업 결과를 DFS 순서 그대로 풀 뒤에 이어붙이고 지역 인덱스를 풀 인덱스로 변환
+        size_t total = pool.size();
+        for (auto& task : tasks) {
+            task.base = static_cast<uint32_t>(total);
+            total += task.nodes.size() - 1;
+        }
+        pool.resize(total);
+
+        #pragma omp parallel for schedule(dynamic, 1)
+        for (int i = 0; i < static_cast<int>(tasks.size()); ++i) {
+            BulkTask& task = tasks[i];
+            const uint32_t offset = task.base - 1; // 지역 1번 -> base
+            for (size_t k = 1; k < task.nodes.size(); ++k) {
+                TrieNode node = task.nodes[k];
+                if (node.firstChild) node.firstChild += offset;
+                if (node.nextSibling) node.nextSibling += offset;
+                pool[static_cast<uint32_t>(offset + k)] = node;
+            }
+            const TrieNode& top = task.nodes[0];
+            TrieNode& parent = pool[task.node];
+            if (top.firstChild) parent.firstChild = top.firstChild + offset;
+            if (top.isEnd) {
+                parent.isEnd = true;
+                parent.id = top.id;
+                parent.isSpecial = top.isSpecial;
+            }
+            std::vector<TrieNode>().swap(task.nodes);
+        }
+    }
+
+    /**
+     * 정렬된 범위 [lo, hi)의 depth번째 바이트로 node의 자식을 만들고,
+     * 자식 범위가 threshold보다 크면 한 단계 더 나누고 아니면 병렬 작업으로 넘깁니다.
+     */
+    void splitTokenRange(const TokenList& list, MemoryPool& pool, uint32_t lo, uint32_t hi, uint32_t depth, uint32_t node,
+                         size_t threshold, std::vector<BulkTask>& tasks) {
+        const std::vector<TokenList::Entry>& entries = list.entries;
+        // 접두사와 같은 토큰은 정렬상 맨 앞에 옴
+        if (lo < hi && entries[lo].length == depth) {
+            pool[node].isEnd = true;
+            pool[node].id = entries[lo].id;
+            pool[node].isSpecial = entries[lo].isSpecial;
+            ++lo;
+        }
+
+        uint32_t prevChild = 0;
+        while (lo < hi) {
+            const unsigned char ch = list.text(entries[lo])[depth];
+            uint32_t end = lo + 1;
+            while (end < hi && list.text(entries[end])[depth] == ch) ++end;
+
+            const uint32_t child = pool.allocate();
+            pool[child].label = ch;
+            if (prevChild) pool[prevChild].nextSibling = child;
+            else pool[node].firstChild = child;
+            prevChild = child;
+
+            if (end - lo > threshold) {
+                splitTokenRange(list, pool, lo, end, depth + 1, child, threshold, tasks);
+            } else {
+                tasks.emplace_back();
+                BulkTask& task = tasks.back();
+                task.lo = lo;
+                task.hi = end;
+                task.depth = depth + 1;
+                task.node = child;
+                task.base = 0;
+            }
+            lo = end;
+        }
+    }
+
+    /**
+     * 병렬 작업 하나: 정렬된 범위의 토큰을 지역 노드 배열에 DFS 순서로 넣습니다.
+     * 토큰이 정렬되어 있으므로 새 노드는 항상 부모의 마지막 자식이 되어 형제 탐색이 필요 없습니다.
+     */
+    static void buildTokenRange(const TokenList& list, BulkTask& task) {
+        const std::vector<TokenList::Entry>& entries = list.entries;
+        std::vector<TrieNode>& nodes = task.nodes;
+        nodes.emplace_back(); // 0번: task.node 대신
+
+        std::vector<uint32_t> path(1, 0);      // path[k]: 접두사 depth + k 바이트에 해당하는 지역 노드
+        std::vector<uint32_t> lastChild(1, 0); // lastChild[k]: path[k]의 마지막 자식 (0이면 없음)
+        const unsigned char* prev = nullptr;
+        uint32_t prevLength = 0;
+
+        for (uint32_t i = task.lo; i < task.hi; ++i) {
+            const TokenList::Entry& e = entries[i];
+            const unsigned char* s = list.text(e);
+
+            uint32_t common = task.depth;
+            if (prev) {
+                const uint32_t limit = std::min(prevLength, e.length);
+                while (common < limit && prev[common] == s[common]) ++common;
+            }
+            path.resize(common - task.depth + 1);
+            lastChild.resize(common - task.depth + 1);
+
+            for (uint32_t d = common; d < e.length; ++d) {
+                const uint32_t k = d - task.depth;
+                const uint32_t n = static_cast<uint32_t>(nodes.size());
+                nodes.emplace_back();
+                nodes[n].label = s[d];
+                if (lastChild[k]) nodes[lastChild[k]].nextSibling = n;
+                else nodes[path[k]].firstChild = n;
+                lastChild[k] = n;
+                path.push_back(n);
+                lastChild.push_back(0);
+            }
+
+            TrieNode& end = nodes[path.back()];
+            end.isEnd = true;
+            end.id = e.id;
+            end.isSpecial = e.isSpecial;
+            prev = s;
+            prevLength = e.length;
+        }
+    }
+
+    // 기본 어휘 토큰 하나를 빌드용 토큰 목록에 추가합니다. (특수 토큰 여부는 added_tokens에서 설정)
+    void addVocabToken(TokenList& tokens, const std::string& token, int id) {
+        tokens.add(token, id, false);
+    }
+
+    // tokenizer.json added_tokens 배열의 항목 하나
+    struct AddedToken {
+        std::string content;
+        int id;
+        bool special;
+        bool hasContent;
+        bool hasId;
+        bool hasSpecial;
+
+        AddedToken(): id(-1), special(false), hasContent(false), hasId(false), hasSpecial(false) {}
+    };
+
+    /****************************************************************
+    * Class Name: JsonLoadHandler
+    * Description: tokenizer.json 스트리밍(SAX) 파서 핸들러
+    *              DOM을 만들지 않고 loadTokenizer에 필요한 값만 골라 읽음
+    *              model.vocab 항목은 읽는 즉시 빌드용 토큰 목록에 추가하고
+    *              merges, normalizer 등 나머지 하위 트리는 값을 보관하지 않고 건너뜀
+    *              added_tokens는 파일에서 model보다 앞에 오므로 모아 두었다가 파싱 후 처리
+    ****************************************************************/
+    class JsonLoadHandler : public json::json_sax_t {
+    public:
+        std::string decoderType;
+        std::string replacement;
+        std::string prefix;
+        std::string unkToken;
+        bool hasDecoderType;
+        bool hasReplacement;
+        bool hasPrefix;
+        bool hasUnkToken;
+        bool vocabIsArray;           // model.vocab이 배열(Unigram 형식)이면 true (지원하지 않음)
+        std::vector<AddedToken> addedTokens;
+        std::string errorMessage;    // 파싱 오류 메시지
+
+        JsonLoadHandler(NemoTokenizer& owner, TokenList& list)
+            : hasDecoderType(false), hasReplacement(false), hasPrefix(false), hasUnkToken(false), vocabIsArray(false),
+              tokenizer(owner), tokens(list) {}
+
+        bool null() override { return true; }
+
+        bool boolean(bool val) override {
+            if (top() == IN_ADDED_TOKEN && currentKey == "special") {
+                addedTokens.back().special = val;
+                addedTokens.back().hasSpecial = true;
+            }
+            return true;
+        }
+
+        bool number_integer(number_integer_t val) override { return number(static_cast<int>(val)); }
+        bool number_unsigned(number_unsigned_t val) override { return number(static_cast<int>(val)); }
+        bool number_float(number_float_t val, const string_t& /*s*/) override { return number(static_cast<int>(val)); }
+
+        bool string(string_t& val) override {
+            switch (top()) {
+            case IN_DECODER:
+                if (currentKey == "type") { decoderType.swap(val); hasDecoderType = true; }
+                else if (currentKey == "replacement") { replacement.swap(val); hasReplacement = true; }
+                else if (currentKey == "prefix") { prefix.swap(val); hasPrefix = true; }
+                break;
+            case IN_MODEL:
+                if (currentKey == "unk_token") { unkToken.swap(val); hasUnkToken = true; }
+                break;
+            case IN_ADDED_TOKEN:
+                if (currentKey == "content") {
+                    addedTokens.back().content.swap(val);
+                    addedTokens.back().hasContent = true;
+                }
+                break;
+            default:
+                break;
+            }
+            return true;
+        }
+
+        bool binary(binary_t& /*val*/) override { return true; }
+
+        bool start_object(std::size_t /*elements*/) override {
+            Scope scope = SKIP;
+            if (scopes.empty()) {
+                scope = IN_ROOT;
+            } else if (top() == IN_ROOT) {
+                if (currentKey == "decoder") scope = IN_DECODER;
+                else if (currentKey == "model") scope = IN_MODEL;
+            } else if (top() == IN_MODEL) {
+                if (currentKey == "vocab") scope = IN_VOCAB;
+            } else if (top() == IN_ADDED_TOKENS) {
+                addedTokens.emplace_back();
+                scope = IN_ADDED_TOKEN;
+            }
+            scopes.push_back(scope);
+            return true;
+        }
+
+        bool end_object() override {
+            scopes.pop_back();
+            return true;
+        }
+
+        bool start_array(std::size_t /*elements*/) override {
+            Scope scope = SKIP;
+            if (!scopes.empty() && top() == IN_ROOT && currentKey == "added_tokens") scope = IN_ADDED_TOKENS;
+            else if (!scopes.empty() && top() == IN_MODEL && currentKey == "vocab") vocabIsArray = true;
+            scopes.push_back(scope);
+            return true;
+        }
+
+        bool end_array() override {
+            scopes.pop_back();
+            return true;
+        }
+
+        bool key(string_t& val) override {
+            currentKey.swap(val);
+            return true;
+        }
+
+        bool parse_error(std::size_t /*position*/, const std::string& /*last_token*/, const nlohmann::detail::exception& ex) override {
+            errorMessage = ex.what();
+            return false;
+        }
+
+    private:
+        // 현재 읽고 있는 위치 (관심 없는 하위 트리는 SKIP)
+        enum Scope : uint8_t { SKIP, IN_ROOT, IN_DECODER, IN_MODEL, IN_VOCAB, IN_ADDED_TOKENS, IN_ADDED_TOKEN };
+
+        NemoTokenizer& tokenizer;
+        TokenList& tokens;
+        std::vector<Scope> scopes;
+        std::string currentKey;      // 가장 최근에 읽은 객체 키 (값 이벤트는 항상 키 바로 뒤에 옴)
+
+        Scope top() const { return scopes.empty() ? SKIP : scopes.back(); }
+
+        bool number(int val) {
+            if (top() == IN_VOCAB) {
+                tokenizer.addVocabToken(tokens, currentKey, val);
+            } else if (top() == IN_ADDED_TOKEN && currentKey == "id") {
+                addedTokens.back().id = val;
+                addedTokens.back().hasId = true;
+            }
+            return true;
+        }
+    };
+
+    /**
+     * 완성된 TrieNode 트리를 BFS 순서로 순회하며 검색용 Trie를 구성합니다.
+     * 선택된 엔진(trieEngine)만 만들고 빌드용 풀은 호출한 쪽에서 해제합니다.
+     */
+    void buildSearchTrie(const MemoryPool& pool) {
+        const size_t nodeCount = pool.size();
+        const TrieNode& rootNode = pool[0];
+        const int rootId = rootNode.isEnd ? rootNode.id : -1;
+
+        trie.clear();
+        frozenTrie.clear();
+        denseTrie.clear();
+        radixTrie.clear();
+        if (trieEngine == TrieEngine::Radix) {
+            buildRadixTrie(pool);
+            return;
+        }
+
+        if (trieEngine == TrieEngine::Frozen) {
+            frozenTrie.beginBuild(nodeCount);
+            frozenTrie.appendNode(0, rootId, rootNode.isSpecial);
+        } else if (trieEngine == TrieEngine::Dense) {
+            denseTrie.beginBuild(nodeCount);
+            denseTrie.appendNode(0, rootId, rootNode.isSpecial);
+        } else {
+            trie.beginBuild(nodeCount);
+            trie.setValue(trie.root(), rootId, rootNode.isSpecial);
+        }
+
+        // queue[i] = BFS i번째 노드의 풀 인덱스 (i는 곧 FrozenTrie/ByteClassTrie 인덱스)
+        std::vector<uint32_t> queue;
+        std::vector<uint32_t> stateOf(nodeCount, 0); // 풀 인덱스 -> 검색용 Trie 상태
+        queue.reserve(nodeCount);
+        queue.push_back(0);
+
+        unsigned char labels[256];
+        uint32_t children[256];
+        uint32_t states[256];
+
+        for (size_t head = 0; head < queue.size(); ++head) {
+            // 자식 목록 (형제 리스트가 이미 바이트 오름차순)
+            size_t count = 0;
+            pool.forEachChild(queue[head], [&](unsigned char ch, uint32_t child) {
+                labels[count] = ch;
+                children[count++] = child;
+            });
+            if (count == 0) continue;
+
+            const uint32_t firstChild = static_cast<uint32_t>(queue.size());
+            if (trieEngine == TrieEngine::Frozen || trieEngine == TrieEngine::Dense) {
+                // BFS 인덱스를 그대로 노드 번호로 사용
+                for (size_t i = 0; i < count; ++i) {
+                    const TrieNode& child = pool[children[i]];
+                    const int id = child.isEnd ? child.id : -1;
+                    stateOf[children[i]] = (trieEngine == TrieEngine::Frozen)
+                        ? frozenTrie.appendNode(labels[i], id, child.isSpecial)
+                        : denseTrie.appendNode(labels[i], id, child.isSpecial);
+                }
+                if (trieEngine == TrieEngine::Frozen) frozenTrie.setChildren(static_cast<uint32_t>(head), firstChild, static_cast<uint32_t>(count));
+                else denseTrie.setChildren(static_cast<uint32_t>(head), firstChild, static_cast<uint32_t>(count));
+            } else {
+                trie.placeChildren(stateOf[queue[head]], labels, count, states);
+                for (size_t i = 0; i < count; ++i) {
+                    const TrieNode& child = pool[children[i]];
+                    stateOf[children[i]] = states[i];
+                    trie.setValue(states[i], child.isEnd ? child.id : -1, child.isSpecial);
+                }
+            }
+            queue.insert(queue.end(), children, children + count);
+        }
+
+        size_t stateSpace;
+        if (trieEngine == TrieEngine::Frozen) {
+            frozenTrie.finishBuild();
+            stateSpace = frozenTrie.size();
+        } else if (trieEngine == TrieEngine::Dense) {
+            denseTrie.finishBuild();
+            stateSpace = denseTrie.size();
+        } else {
+            trie.finishBuild();
+            annotateDoubleArray(pool, queue, stateOf);
+            stateSpace = trie.size();
+        }
+
+        buildLinMaxMatch(pool, stateOf, stateSpace);
+    }
+
+    /**
+     * Double-Array Trie 유닛에 최장 일치 탐색용 주석을 설정합니다.
+     * (경로상 가장 깊은 종료 노드와 그 이후 바이트 수, 남은 최대 깊이)
+     * @param order BFS 순서의 풀 인덱스 (부모가 항상 자식보다 앞)
+     * @param stateOf 풀 인덱스 -> Double-Array 상태
+     */
+    void annotateDoubleArray(const MemoryPool& pool, const std::vector<uint32_t>& order, const std::vector<uint32_t>& stateOf) {
+        const size_t nodeCount = pool.size();
+        std::vector<int> bestId(nodeCount, -1);
+        std::vector<uint32_t> back(nodeCount, 0);
+        std::vector<uint32_t> height(nodeCount, 0);
+
+        // 위에서 아래로: 경로상 가장 깊은 종료 노드
+        if (pool[0].isEnd) bestId[0] = pool[0].id;
+        for (uint32_t u : order) {
+            pool.forEachChild(u, [&](unsigned char, uint32_t v) {
+                if (pool[v].isEnd) {
+                    bestId[v] = pool[v].id;
+                } else {
+                    bestId[v] = bestId[u];
+                    back[v] = back[u] + 1;
+                }
+            });
+        }
+
+        // 아래에서 위로: 남은 최대 깊이
+        for (size_t k = order.size(); k-- > 0; ) {
+            const uint32_t u = order[k];
+            pool.forEachChild(u, [&](unsigned char, uint32_t v) {
+                height[u] = std::max(height[u], height[v] + 1);
+            });
+        }
+
+        bool annotated = true;
+        for (uint32_t u : order) {
+            if (!trie.setAnnotation(stateOf[u], bestId[u], back[u], height[u])) annotated = false;
+        }
+        trie.setAnnotated(annotated);
+    }
+
+    /**
+     * TrieNode 트리를 BFS 순서로 순회하며 Radix Trie를 구성합니다.
+     * 자식이 하나뿐인 비종료 노드는 다음 노드와 합쳐 하나의 간선 레이블이 됩니다.
+     * Radix Trie의 상태는 간선 중간 위치를 포함하므로 failure link는 만들지 않습니다. (탐욕 매칭 사용)
+     */
+    void buildRadixTrie(const MemoryPool& pool) {
+        const TrieNode& rootNode = pool[0];
+        linMaxMatch.clear();
+        radixTrie.beginBuild(pool.size() / 2 + 1);
+        radixTrie.appendNode(nullptr, 0, rootNode.isEnd ? rootNode.id : -1, rootNode.isSpecial);
+
+        // queue[i] = Radix Trie i번째 노드에 대응하는 풀 인덱스 (간선 레이블의 마지막 노드)
+        std::vector<uint32_t> queue;
+        queue.reserve(pool.size() / 2 + 1);
+        queue.push_back(0);
+        std::vector<unsigned char> label;
+        label.reserve(RadixTrie::MAX_LABEL);
+
+        for (size_t head = 0; head < queue.size(); ++head) {
+            const uint32_t firstChild = static_cast<uint32_t>(queue.size());
+            uint32_t count = 0;
+            pool.forEachChild(queue[head], [&](unsigned char ch, uint32_t child) {
+                label.assign(1, ch);
+                uint32_t v = child;
+                while (!pool[v].isEnd && pool[v].firstChild && !pool[pool[v].firstChild].nextSibling
+                       && label.size() < RadixTrie::MAX_LABEL) {
+                    v = pool[v].firstChild;
+                    label.push_back(pool[v].label);
+                }
+                const TrieNode& node = pool[v];
+                radixTrie.appendNode(label.data(), label.size(), node.isEnd ? node.id : -1, node.isSpecial);
+                queue.push_back(v);
+                ++count;
+            });
+            if (count) radixTrie.setChildren(static_cast<uint32_t>(head), firstChild, count);
+        }
+        radixTrie.finishBuild();
+
+        // 상태 번호에 노드 번호 24비트만 쓰므로 넘치면 Double-Array Trie로 대체
+        if (radixTrie.size() > RadixTrie::MAX_NODES) {
+            std::cerr << "Warning: Radix Trie 노드 수가 너무 많아 Double-Array Trie를 사용합니다.\n";
+            radixTrie.clear();
+            trieEngine = TrieEngine::DoubleArray;
+            buildSearchTrie(pool);
+        }
+    }
+
+    /**
+     * 단어 시작("▁")과 WordPiece 이어지는 조각("##")의 시작 상태를 미리 계산합니다.
+     * 매칭할 때 단어마다 접두사를 복사하거나 조각마다 접두사를 다시 따라가지 않기 위함입니다.
+     * 접두사 중간에 끝나는 토큰이 있거나 접두사가 한 문자가 아니면 기존 방식(버퍼 복사)을 사용합니다.
+     */
+    void cacheStartStates() {
+        hasWordStartState = false;
+        wordStartPrefixId = -1;
+        hasContinuationState = false;
+
+        withTrie([&](const auto& t) {
+            if (decoderType == "WordPiece") {
+                // 기존 매칭과 동일하게 접두사의 앞 2바이트만 따라감
+                uint32_t state = t.root();
+                hasContinuationState = t.next(state, static_cast<unsigned char>(subwordPrefix[0]))
+                                    && t.next(state, static_cast<unsigned char>(subwordPrefix[1]));
+                continuationState = state;
+                return;
+            }
+
+            if (subwordPrefix.empty()) return;
+
+            // UNK 처리 시 한 문자를 건너뛰면 정확히 단어 시작에 도달해야 함
+            unsigned char c = static_cast<unsigned char>(subwordPrefix[0]);
+            size_t charBytes = ((c & 0x80) == 0) ? 1 :
+                               ((c & 0xE0) == 0xC0) ? 2 :
+                               ((c & 0xF0) == 0xE0) ? 3 :
+                               ((c & 0xF8) == 0xF0) ? 4 : 1;
+            if (charBytes != subwordPrefix.size()) return;
+
+            uint32_t state = t.root();
+            for (size_t i = 0; i < subwordPrefix.size(); ++i) {
+                if (!t.next(state, static_cast<unsigned char>(subwordPrefix[i]))) return;
+                if (i + 1 < subwordPrefix.size() && t.value(state) != -1) return;
+            }
+            wordStartState = state;
+            wordStartPrefixId = t.value(state);
+            hasWordStartState = true;
+        });
+
+        // 각 시작 상태의 2바이트 직접 테이블 (65,536칸)
+        rootTable.clear();
+        startTable.clear();
+        withTrie([&](const auto& t) {
+            rootTable.build(t, t.root());
+            if (decoderType == "WordPiece") {
+                if (hasContinuationState) startTable.build(t, continuationState);
+            } else if (hasWordStartState) {
+                startTable.build(t, wordStartState);
+            }
+        });
+    }
+
+    // 현재 선택된 검색용 Trie로 f(trie)를 호출합니다.
+    template <class F>
+    void withTrie(F&& f) const {
+        switch (trieEngine) {
+        case TrieEngine::Frozen: f(frozenTrie); break;
+        case TrieEngine::Dense: f(denseTrie); break;
+        case TrieEngine::Radix: f(radixTrie); break;
+        default: f(trie); break;
+        }
+    }
+
+    /**
+     * WordPiece용 failure link와 failure pop을 계산합니다. (LinMaxMatch)
+     * f(v): v에서 더 진행할 수 없을 때 pop 이후 이어서 매칭할 노드
+     * F(v): 그때 출력할 토큰들 (f(v)가 없으면 탐욕 매칭으로 넘기기 전까지 출력할 토큰들)
+     * "##" 서브트리의 failure link는 항상 더 얕은 노드를 가리키므로 먼저 BFS로 처리하고,
+     * 루트 서브트리는 그 결과를 이용해 두 번째로 처리합니다.
+     */
+    void buildLinMaxMatch(const MemoryPool& pool, const std::vector<uint32_t>& stateOf, size_t stateSpace) {
+        linMaxMatch.clear();
+        // 기존 탐욕 매칭과 동일하게 접두사가 정확히 2바이트인 경우만 지원
+        if (decoderType != "WordPiece" || subwordPrefix.size() != 2) return;
+
+        uint32_t prefixNode = pool.child(0, static_cast<unsigned char>(subwordPrefix[0]));
+        if (prefixNode) prefixNode = pool.child(prefixNode, static_cast<unsigned char>(subwordPrefix[1]));
+        if (!prefixNode) return; // "##" 노드가 없으면 탐욕 매칭 사용
+
+        const uint32_t NONE = LinMaxMatch::NONE;
+        const size_t nodeCount = pool.size();
+        std::vector<uint32_t> fail(nodeCount, NONE);
+        std::vector<uint32_t> popOffset(nodeCount, 0);
+        std::vector<uint32_t> popCount(nodeCount, 0);
+        std::vector<uint32_t> inputLength(nodeCount, 0); // 노드까지의 입력 바이트 수 ("##" 제외)
+        std::vector<LinMaxMatch::Pop> pops;
+        std::vector<LinMaxMatch::Pop> scratch;
+        std::vector<uint32_t> queue;
+        queue.reserve(nodeCount);
+
+        auto expand = [&](uint32_t start) {
+            queue.clear();
+            queue.push_back(start);
+            for (size_t head = 0; head < queue.size(); ++head) {
+                const uint32_t u = queue[head];
+                pool.forEachChild(u, [&](unsigned char ch, uint32_t v) {
+                    if (v == prefixNode) return; // "##" 서브트리는 이미 처리됨
+                    queue.push_back(v);
+                    inputLength[v] = inputLength[u] + 1;
+
+                    scratch.clear();
+                    const TrieNode& node = pool[v];
+                    if (node.isEnd) {
+                        // 종료 노드: 자기 자신을 출력하고 "##"부터 다시 시작
+                        LinMaxMatch::Pop pop = { node.id, inputLength[v] };
+                        scratch.push_back(pop);
+                        fail[v] = prefixNode;
+                    } else {
+                        scratch.insert(scratch.end(), pops.begin() + popOffset[u], pops.begin() + popOffset[u] + popCount[u]);
+                        uint32_t z = fail[u];
+                        while (z != NONE && !pool.child(z, ch)) {
+                            scratch.insert(scratch.end(), pops.begin() + popOffset[z], pops.begin() + popOffset[z] + popCount[z]);
+                            z = fail[z];
+                        }
+                        fail[v] = (z != NONE) ? pool.child(z, ch) : NONE;
+                    }
+                    popOffset[v] = static_cast<uint32_t>(pops.size());
+                    popCount[v] = static_cast<uint32_t>(scratch.size());
+                    pops.insert(pops.end(), scratch.begin(), scratch.end());
+                });
+            }
+        };
+        expand(prefixNode); // 1단계: "##" 서브트리
+        expand(0);          // 2단계: 루트 서브트리
+
+        // 풀 인덱스를 검색용 Trie 상태 번호로 변환하여 저장
+        linMaxMatch.beginBuild(stateSpace, stateOf[0], stateOf[prefixNode]);
+        for (size_t n = 0; n < nodeCount; ++n) {
+            if (fail[n] == NONE && popCount[n] == 0) continue;
+            linMaxMatch.setEntry(stateOf[n], fail[n] == NONE ? NONE : stateOf[fail[n]],
+                                 pops.data() + popOffset[n], popCount[n]);
+        }
+        linMaxMatch.finishBuild();
+    }
+
+    // 매칭 결과를 토큰 문자열로 모으는 출력기 (tokenize용)
+    struct TokenSink {
+        std::vector<std::string>& tokens;
+        const std::string& prefix;
+        const std::string& unk;
+
+        TokenSink(std::vector<std::string>& t, const std::string& p, const std::string& u): tokens(t), prefix(p), unk(u) {}
+
+        void token(int /*id*/, const char* ptr, size_t len, bool withPrefix) {
+            // 직접 메모리에서 토큰 생성 (복사 최소화)
+            if (withPrefix) tokens.emplace_back(prefix + std::string(ptr, len));
+            else tokens.emplace_back(ptr, len);
+        }
+        void unknown() { tokens.push_back(unk); } // UNK 토큰은 한 번만 복사
+    };
+
+    // 매칭 결과를 토큰 ID로 모으는 출력기 (encode용)
+    struct IdSink {
+        std::vector<int>& ids;
+        int unkId;
+
+        IdSink(std::vector<int>& i, int u): ids(i), unkId(u) {}
+
+        void token(int id, const char*, size_t, bool) { ids.push_back(id); }
+        void unknown() { ids.push_back(unkId); }
+    };
+
+    // 매칭 결과를 호출자 버퍼에 쓰는 출력기 (encode_into용)
+    // 용량을 넘는 ID는 쓰지 않고 개수만 세어 필요한 크기를 알려줌
+    struct BufferSink {
+        int32_t* out;
+        size_t capacity;
+        size_t count;
+        int unkId;
+
+        BufferSink(int32_t* o, size_t c, int u): out(o), capacity(c), count(0), unkId(u) {}
+
+        void put(int id) {
+            if (count < capacity) out[count] = id;
+            ++count;
+        }
+        void token(int id, const char*, size_t, bool) { put(id); }
+        void unknown() { put(unkId); }
+    };
+
+    /**
+     * 텍스트를 단어 경계 탐색과 Trie 매칭을 한 번에 수행하여 sink에 출력합니다.
+     * 단어를 std::string으로 만들지 않고 원본 텍스트의 구간(포인터, 길이)을 바로 매칭합니다.
+     * Trie 타입(DoubleArrayTrie, FrozenTrie, ByteClassTrie, RadixTrie)에 대해 템플릿으로 구현하여 순회 비용에 가상 호출이 끼지 않음
+     */
+    template <class Trie, class Sink>
+    void matchText(const Trie& t, const char* text, size_t textLength, Sink& sink) const {
+        const bool isWordPiece = (decoderType == "WordPiece");
+        const bool useLinear = isWordPiece && linMaxMatch.enabled();
+
+        // SentencePiece 접두사를 붙일 버퍼 (시작 상태를 쓸 수 없는 경우에만 사용)
+        static thread_local std::string buffer;
+
+        if (interleaved && canInterleave(t) && (isWordPiece || hasWordStartState)) {
+            // 단어를 INTERLEAVE_LANES개씩 모아 번갈아 매칭
+            const char* words[INTERLEAVE_LANES];
+            size_t lengths[INTERLEAVE_LANES];
+            size_t count = 0;
+            forEachWord(text, textLength, [&](const char* word, size_t length) {
+                words[count] = word;
+                lengths[count++] = length;
+                if (count == INTERLEAVE_LANES) {
+                    matchWordsInterleaved(t, words, lengths, count, sink);
+                    count = 0;
+                }
+            });
+            if (count) matchWordsInterleaved(t, words, lengths, count, sink);
+            return;
+        }
+
+        forEachWord(text, textLength, [&](const char* word, size_t length) {
+            // 입력 준비 (WordPiece 또는 SentencePiece에 따라 다름)
+            const char* input_ptr = word;
+            size_t input_length = length;
+
+            if (!isWordPiece && hasWordStartState) {
+                // "▁"를 복사하지 않고 미리 계산한 상태에서 첫 조각을 매칭
+                size_t position = matchWordStart(t, word, length, sink);
+                while (position < length) {
+                    position = matchPiece(t, word, position, length, false, sink);
+                }
+                return;
+            }
+
+            if (!isWordPiece) {
+                // SentencePiece인 경우 prefix 추가
+                buffer.assign(subwordPrefix);
+                buffer.append(word, length);
+                input_ptr = buffer.data();
+                input_length = buffer.length();
+            }
+
+            if (useLinear) {
+                matchWordLinear(t, input_ptr, input_length, sink);
+                return;
+            }
+
+            size_t position = 0;
+            bool isSubword = false;
+
+            while (position < input_length) {
+                position = matchPiece(t, input_ptr, position, input_length, isSubword && isWordPiece, sink);
+                isSubword = true;
+            }
+        });
+    }
+
+    // Radix Trie는 간선 단위 비교가 더 빠르므로 바이트 단위로 번갈아 매칭하지 않음
+    template <class Trie>
+    static bool canInterleave(const Trie&) { return true; }
+    static bool canInterleave(const RadixTrie&) { return false; }
+
+    /**
+     * 여러 단어를 한 바이트씩 번갈아 매칭합니다. (software pipelining)
+     * 한 단어의 Trie 순회는 매 단계가 이전 로드에 의존하므로, 단어 하나를 한 단계 진행한 뒤
+     * 다음 전이에 필요한 캐시 라인을 프리페치하고 다른 단어로 넘어가 메모리 지연을 겹칩니다.
+     * 결과는 단어별로 모았다가 원래 순서대로 sink에 전달하므로 단어별 매칭과 동일합니다.
+     */
+    template <class Trie, class Sink>
+    void matchWordsInterleaved(const Trie& t, const char* const* words, const size_t* lengths, size_t count, Sink& sink) const {
+        static thread_local std::vector<PieceEvent> events[INTERLEAVE_LANES];
+        const bool isWordPiece = (decoderType == "WordPiece");
+
+        Lane lanes[INTERLEAVE_LANES];
+        size_t active[INTERLEAVE_LANES]; // 진행 중인 lane 번호
+        size_t activeCount = 0;
+
+        for (size_t k = 0; k < count; ++k) {
+            Lane& lane = lanes[k];
+            lane.word = words[k];
+            lane.length = lengths[k];
+            lane.position = 0;
+            lane.wordStart = !isWordPiece;
+            lane.continuation = false;
+            events[k].clear();
+            if (startPiece(t, lane, events[k])) active[activeCount++] = k;
+        }
+
+        while (activeCount) {
+            for (size_t a = 0; a < activeCount; ) {
+                const size_t k = active[a];
+                if (stepPiece(t, lanes[k], events[k])) {
+                    ++a;
+                } else {
+                    active[a] = active[--activeCount]; // 끝난 lane 제거
+                }
+            }
+        }
+
+        for (size_t k = 0; k < count; ++k) {
+            for (const PieceEvent& e : events[k]) {
+                if (e.id == -1) sink.unknown();
+                else sink.token(e.id, lanes[k].word + e.offset, e.length, e.withPrefix);
+            }
+        }
+    }
+
+    /**
+     * lane의 다음 조각 매칭을 시작합니다. (시작 상태 선택 및 2바이트 직접 테이블 적용)
+     * @return 진행할 조각이 남아 있으면 true, 단어가 끝났으면 false
+     */
+    template <class Trie>
+    bool startPiece(const Trie& t, Lane& lane, std::vector<PieceEvent>& events) const {
+        while (lane.position < lane.length) {
+            const FirstLevelTable* first = &rootTable;
+            lane.state = t.root();
+            if (lane.wordStart) {
+                lane.state = wordStartState;
+                first = &startTable;
+            } else if (lane.continuation) {
+                if (!hasContinuationState) return false; // "##" 노드가 없으면 단어 처리 중단
+                lane.state = continuationState;
+                first = &startTable;
+            }
+            lane.matchedId = -1;
+            lane.matchedLen = 0;
+            lane.scan = 0;
+
+            const size_t remaining = lane.length - lane.position;
+            if (remaining >= 2 && first->enabled()) {
+                const char* p = lane.word + lane.position;
+                const FirstLevelTable::Entry& e = first->lookup(static_cast<unsigned char>(p[0]), static_cast<unsigned char>(p[1]));
+                if (e.best) {
+                    lane.matchedId = FirstLevelTable::bestId(e);
+                    lane.matchedLen = FirstLevelTable::bestLength(e);
+                }
+                if (e.state == FirstLevelTable::NONE) {
+                    finishPiece(lane, events); // 2바이트 안에서 조각이 끝남
+                    continue;
+                }
+                lane.state = e.state;
+                lane.scan = 2;
+            }
+
+            if (lane.scan < remaining) {
+                t.prefetch(lane.state, static_cast<unsigned char>(lane.word[lane.position + lane.scan]));
+            }
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * lane을 한 바이트 진행합니다. 더 진행할 수 없으면 조각을 출력하고 다음 조각을 시작합니다.
+     * @return lane이 아직 진행 중이면 true
+     */
+    template <class Trie>
+    bool stepPiece(const Trie& t, Lane& lane, std::vector<PieceEvent>& events) const {
+        const size_t remaining = std::min(lane.length - lane.position, maxTokenLength);
+        if (lane.scan < remaining) {
+            const char* p = lane.word + lane.position;
+            uint32_t next = lane.state;
+            if (t.next(next, static_cast<unsigned char>(p[lane.scan]))) {
+                lane.state = next;
+                ++lane.scan;
+                const int id = t.value(next);
+                if (id != -1) {
+                    lane.matchedId = id;
+                    lane.matchedLen = static_cast<int>(lane.scan);
+                }
+                if (lane.scan < remaining) t.prefetch(next, static_cast<unsigned char>(p[lane.scan]));
+                return true;
+            }
+        }
+
+        finishPiece(lane, events);
+        return startPiece(t, lane, events);
+    }
+
+    // 조각 하나의 매칭 결과를 기록하고 다음 조각 위치로 이동합니다. (matchPiece / matchWordStart와 동일한 규칙)
+    void finishPiece(Lane& lane, std::vector<PieceEvent>& events) const {
+        const bool isWordPiece = (decoderType == "WordPiece");
+
+        if (lane.wordStart) {
+            lane.wordStart = false;
+            PieceEvent e = { -1, 0, 0, true };
+            if (lane.matchedId != -1) {
+                e.id = lane.matchedId;
+                e.length = static_cast<uint32_t>(lane.matchedLen);
+                lane.position = lane.matchedLen;
+            } else if (wordStartPrefixId != -1) {
+                e.id = wordStartPrefixId; // "▁" 단독 토큰
+            }
+            events.push_back(e);
+            return;
+        }
+
+        if (lane.matchedId != -1) {
+            PieceEvent e = { lane.matchedId, static_cast<uint32_t>(lane.position), static_cast<uint32_t>(lane.matchedLen), lane.continuation };
+            events.push_back(e);
+            lane.position += lane.matchedLen;
+        } else {
+            PieceEvent e = { -1, 0, 0, false };
+            events.push_back(e);
+
+            // UTF-8 문자 바이트 크기만큼 건너뜀
+            unsigned char c = lane.word[lane.position];
+            int byteCount = ((c & 0x80) == 0) ? 1 :
+                            ((c & 0xE0) == 0xC0) ? 2 :
+                            ((c & 0xF0) == 0xE0) ? 3 :
+                            ((c & 0xF8) == 0xF0) ? 4 : 1;
+            lane.position += std::min(static_cast<size_t>(byteCount), lane.length - lane.position);
+        }
+        if (isWordPiece) lane.continuation = true;
+    }
+
+    /**
+     * SentencePiece 단어의 첫 조각("▁" + 단어 앞부분)을 wordStartState에서 매칭합니다.
+     * 출력 토큰은 sink에 접두사 포함으로 전달됩니다.
+     * @return 단어 안에서 다음 조각의 시작 위치
+     */
+    template <class Trie, class Sink>
+    size_t matchWordStart(const Trie& t, const char* word, size_t length, Sink& sink) const {
+        int matchedId = -1;
+        int matchedLen = 0;
+        longestMatch(t, startTable, wordStartState, word, std::min(length, maxTokenLength), matchedId, matchedLen);
+
+        if (matchedId != -1) {
+            sink.token(matchedId, word, matchedLen, true);
+            return matchedLen;
+        }
+        if (wordStartPrefixId != -1) {
+            sink.token(wordStartPrefixId, word, 0, true); // "▁" 단독 토큰
+            return 0;
+        }
+
+        sink.unknown(); // 접두사 문자 하나를 UNK로 건너뜀
+        return 0;
+    }
+
+    /**
+     * position에서 시작하는 한 조각을 탐욕적 최장 일치로 매칭하여 출력합니다.
+     * @param continuation WordPiece 단어 중간 조각 여부 (## 접두사부터 순회)
+     * @return 다음 조각의 시작 위치 (## 노드가 없으면 length를 반환하여 단어 처리 중단)
+     */
+    template <class Trie, class Sink>
+    size_t matchPiece(const Trie& t, const char* input_ptr, size_t position, size_t input_length, bool continuation, Sink& sink) const {
+        size_t remaining = input_length - position;
+        int matchedId = -1;
+        int matchedLen = 0;
+
+        // Trie 순회
+        uint32_t current = t.root();
+        const FirstLevelTable* first = &rootTable;
+        if (continuation) { // wordpiece이고 단어 중간에 끊긴 경우 미리 계산한 ## 상태에서 시작
+            if (!hasContinuationState) return input_length;
+            current = continuationState;
+            first = &startTable;
+        }
+
+        // 가장 긴 토큰보다 길게 따라갈 필요 없음
+        longestMatch(t, *first, current, input_ptr + position, std::min(remaining, maxTokenLength), matchedId, matchedLen);
+
+        if (matchedId != -1) {
+            sink.token(matchedId, input_ptr + position, matchedLen, continuation);
+            return position + matchedLen;
+        }
+
+        sink.unknown();
+
+        // UTF-8 문자 바이트 크기 계산
+        unsigned char c = input_ptr[position];
+        int byteCount = ((c & 0x80) == 0) ? 1 :
+                        ((c & 0xE0) == 0xC0) ? 2 :
+                        ((c & 0xF0) == 0xE0) ? 3 :
+                        ((c & 0xF8) == 0xF0) ? 4 : 1;
+
+        return position + std::min(static_cast<size_t>(byteCount), remaining);
+    }
+
+    // state에서 시작하는 최장 일치 토큰을 바이트 단위로 찾습니다.
+    template <class Trie>
+    static void longestMatch(const Trie& t, uint32_t current, const char* ptr, size_t length, int& matchedId, int& matchedLen) {
+        for (size_t i = 0; i < length; ++i) {
+            unsigned char ch = static_cast<unsigned char>(ptr[i]);
+            if (!t.next(current, ch)) break;
+            int id = t.value(current);
+            if (id != -1) {
+                matchedId = id;
+                matchedLen = i + 1;
+            }
+        }
+    }
+
+    // Double-Array Trie는 유닛의 최장 일치 주석으로 단계마다 토큰 ID를 확인하지 않음
+    static void longestMatch(const DoubleArrayTrie& t, uint32_t current, const char* ptr, size_t length, int& matchedId, int& matchedLen) {
+        t.longestMatch(current, ptr, length, matchedId, matchedLen);
+    }
+
+    // Radix Trie는 간선 레이블 단위로 한 번에 비교
+    static void longestMatch(const RadixTrie& t, uint32_t current, const char* ptr, size_t length, int& matchedId, int& matchedLen) {
+        t.longestMatch(current, ptr, length, matchedId, matchedLen);
+    }
+
+    // start 상태의 2바이트 직접 테이블(first)로 상위 두 단계를 건너뛴 뒤 최장 일치를 찾습니다.
+    template <class Trie>
+    static void longestMatch(const Trie& t, const FirstLevelTable& first, uint32_t start, const char* ptr, size_t length, int& matchedId, int& matchedLen) {
+        if (length < 2 || !first.enabled()) {
+            longestMatch(t, start, ptr, length, matchedId, matchedLen);
+            return;
+        }
+
+        const FirstLevelTable::Entry& e = first.lookup(static_cast<unsigned char>(ptr[0]), static_cast<unsigned char>(ptr[1]));
+        if (e.best) {
+            matchedId = FirstLevelTable::bestId(e);
+            matchedLen = FirstLevelTable::bestLength(e);
+        }
+        if (e.state == FirstLevelTable::NONE) return;
+
+        int deeperId = -1;
+        int deeperLen = 0;
+        longestMatch(t, e.state, ptr + 2, length - 2, deeperId, deeperLen);
+        if (deeperId != -1) {
+            matchedId = deeperId;
+            matchedLen = deeperLen + 2;
+        }
+    }
+
+    /**
+     * WordPiece 단어 하나를 failure link로 선형 시간에 매칭합니다. (LinMaxMatch)
+     * 각 바이트는 Trie를 한 번만 따라가며, 출력은 matchPiece 반복과 동일합니다.
+     * failure link가 없는 경우(UNK가 나오는 구간)만 matchPiece로 한 조각 처리한 뒤 재개합니다.
+     */
+    template <class Trie, class Sink>
+    void matchWordLinear(const Trie& t, const char* input_ptr, size_t input_length, Sink& sink) const {
+        const uint32_t prefixState = linMaxMatch.prefix();
+        uint32_t state = t.root();
+        size_t pieceStart = 0;   // 아직 출력하지 않은 구간의 시작 위치
+        bool isSubword = false;
+        size_t i = 0;
+
+        for (;;) {
+            if (i < input_length) {
+                // 조각 시작 위치에서는 2바이트 직접 테이블로 두 번의 전이를 한 번에 처리
+                if (i + 1 < input_length && (state == prefixState || state == t.root())) {
+                    const FirstLevelTable& first = (state == prefixState) ? startTable : rootTable;
+                    if (first.enabled()) {
+                        const FirstLevelTable::Entry& e = first.lookup(static_cast<unsigned char>(input_ptr[i]), static_cast<unsigned char>(input_ptr[i + 1]));
+                        if (e.state != FirstLevelTable::NONE) {
+                            state = e.state;
+                            i += 2;
+                            continue;
+                        }
+                    }
+                }
+
+                uint32_t next = state;
+                if (t.next(next, static_cast<unsigned char>(input_ptr[i]))) {
+                    state = next;
+                    ++i;
+                    continue;
+                }
+            } else if (state == prefixState || state == t.root()) {
+                break; // 남은 구간 없음
+            }
+
+            // 더 진행할 수 없음: failure pop 출력 후 failure link로 이동
+            const LinMaxMatch::Entry& e = linMaxMatch.entry(state);
+            const LinMaxMatch::Pop* pop = linMaxMatch.popsOf(e);
+            for (uint32_t k = 0; k < e.popCount; ++k) {
+                sink.token(pop[k].id, input_ptr + pieceStart, pop[k].length, isSubword);
+                pieceStart += pop[k].length;
+                isSubword = true;
+            }
+
+            if (e.fail != LinMaxMatch::NONE) {
+                state = e.fail;
+                continue;
+            }
+
+            // failure link 없음: 남은 구간 시작에서 한 조각을 탐욕 매칭(UNK 처리 포함)
+            if (pieceStart >= input_length) break;
+            pieceStart = matchPiece(t, input_ptr, pieceStart, input_length, isSubword, sink);
+            isSubword = true;
+            state = prefixState;
+            i = pieceStart;
+        }
+    }
+
+    // 토큰 문자열 전체를 따라가 도달한 상태를 구합니다.
+    template <class Trie>
+    static bool findState(const Trie& t, const std::string& token, uint32_t& state) {
+        state = t.root();
+        for (unsigned char ch : token) {
+            if (!t.next(state, ch)) return false;
+        }
+        return true;
     }
 
 public:
-    NemoTokenizer(): nodePool(nullptr), root(nullptr) {initLookupTables();} // 생성자
-    ~NemoTokenizer() { delete nodePool; } // 소멸자 (메모리 관리)
+    NemoTokenizer(): trieEngine(TrieEngine::DoubleArray), engineSetting(TrieEngine::DoubleArray), interleaved(false), interleavedSetting(false), decodeTables(true), wordStartState(0), wordStartPrefixId(-1), hasWordStartState(false),
+                     continuationState(0), hasContinuationState(false), maxTokenLength(0) {initLookupTables();} // 생성자
+
+    /**
+     * 검색용 Trie 엔진을 선택합니다. 다음 loadTokenizer 호출부터 적용되며,
+     * 이미 로드된 Trie는 바꾸지 않으므로 다른 스레드의 encode/tokenize에 영향을 주지 않습니다.
+     * @param engine 사용할 엔진
+     */
+    void setTrieEngine(TrieEngine engine) { engineSetting = engine; }
+    TrieEngine getTrieEngine() const { return engineSetting; }
+
+    // 지금 로드된 Trie의 엔진 (loadCompiled는 저장된 엔진, Radix가 너무 크면 DoubleArray)
+    TrieEngine getActiveTrieEngine() const { return trieEngine; }
+
+    // 모델이 로드(또는 연결)되었는지 여부
+    bool isLoaded() const { return !decoderType.empty(); }
+
+    /**
+     * 여러 단어를 번갈아 매칭하는 방식을 사용할지 설정합니다. (결과는 동일)
+     * Trie가 L2 캐시보다 큰 대용량 어휘에서 메모리 지연을 겹쳐 숨깁니다.
+     * 다음 로드(loadTokenizer, loadCompiled 등)부터 적용됩니다.
+     * @param enable 사용 여부
+     */
+    void setInterleavedMatching(bool enable) { interleavedSetting = enable; }
+    bool getInterleavedMatching() const { return interleavedSetting; }
+
+    /**
+     * 디코드/변환용 ID/토큰 맵을 만들 수 있게 할지 설정합니다. 다음 loadTokenizer 호출부터 적용됩니다.
+     * 켜져 있으면(기본값) 맵은 처음 decode/convert_* 호출 시 만들어지고,
+     * 꺼져 있으면 encode/tokenize만 하는 작업용으로 원본도 보관하지 않아
+     * decode, convert_ids_to_tokens, convert_tokens_to_ids가 토큰을 찾지 못합니다.
+     * @param enable 사용 여부
+     */
+    void setDecodeTables(bool enable) { decodeTables = enable; }
+    bool getDecodeTables() const { return decodeTables; }
+
+    /**
+     * 주요 내부 구조의 메모리 사용량(바이트)을 반환합니다.
+     * @return (구조 이름, 바이트 수) 리스트
+     */
+    std::vector<std::pair<std::string, size_t>> memoryUsage() const {
+        std::vector<std::pair<std::string, size_t>> usage;
+        size_t trieBytes = 0;
+        withTrie([&trieBytes](const auto& t) { trieBytes = t.memoryUsage(); });
+        usage.emplace_back("trie", trieBytes);
+        usage.emplace_back("lin_max_match", linMaxMatch.memoryUsage());
+        usage.emplace_back("first_level", rootTable.memoryUsage() + startTable.memoryUsage());
+        usage.emplace_back("id_table", idTable.memoryUsage());
+        usage.emplace_back("token_hash", tokenHash.memoryUsage());
+        usage.emplace_back("vocab_blob", tokenHash.blobLength());
+        return usage;
+    }
 
     void loadTokenizer(const std::string& filename) {
-        std::ifstream file(filename);
+        if (!tryLoadTokenizer(filename)) {
+            exit(1);
+        }
+    }
+
+    /**
+     * tokenizer.json 파일로 토크나이저를 로드합니다.
+     * loadTokenizer와 달리 파일이 없거나 올바르지 않으면 종료하지 않고 기존 상태를 유지한 채 false를 반환합니다.
+     * (사용 중인 모델을 교체하는 경로용, SwappableTokenizer와 Python 바인딩)
+     * @param filename tokenizer.json 파일 경로
+     * @return 성공 여부
+     */
+    bool tryLoadTokenizer(const std::string& filename) {
+        std::ifstream file(filename, std::ios::binary);
         if (!file.is_open()) {
             std::cerr << "Error: tokenizer.json 파일을 열 수 없습니다.\n";
-            exit(1);
+            return false;
+        }
+
+        std::string error;
+        if (!loadJson([&file](JsonLoadHandler& handler) { return json::sax_parse(file, &handler); }, error)) {
+            std::cerr << "Error: " << error << "\n";
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * 메모리에 있는 tokenizer.json 내용으로 토크나이저를 로드합니다. (모델 저장소에서 받은 바이트 등)
+     * loadTokenizer와 달리 내용이 올바르지 않으면 종료하지 않고 기존 상태를 유지한 채 false를 반환합니다.
+     * 다른 스레드가 사용 중인 인스턴스를 바꾸려면 새 인스턴스에 로드한 뒤 교체합니다. (SwappableTokenizer)
+     * @param data tokenizer.json 내용
+     * @param size 바이트 수
+     * @return 성공 여부
+     */
+    bool loadFromBuffer(const char* data, size_t size) {
+        std::string error;
+        if (!loadJson([data, size](JsonLoadHandler& handler) { return json::sax_parse(data, data + size, &handler); }, error)) {
+            std::cerr << "Error: " << error << "\n";
+            return false;
         }
-    
-        json tokenizer;
-        file >> tokenizer;
-    
+        return true;
+    }
+
+private:
+    /**
+     * tokenizer.json을 스트리밍 파싱하여 토크나이저를 구성합니다.
+     * 파싱과 검증이 모두 끝난 뒤에 멤버를 바꾸므로 실패하면 기존 상태가 그대로 남습니다.
+     * @param parse JsonLoadHandler로 입력을 파싱하는 함수 (성공 여부 반환)
+     * @param error 실패 이유
+     * @return 성공 여부
+     */
+    template <class Parse>
+    bool loadJson(Parse parse, std::string& error) {
+        // DOM 없이 스트리밍 파싱 (기본 어휘는 읽는 즉시 tokens에 추가됨)
+        TokenList tokens;
+        JsonLoadHandler handler(*this, tokens);
+        if (!parse(handler)) {
+            error = "tokenizer.json 파싱 실패: " + handler.errorMessage;
+            return false;
+        }
+        if (handler.vocabIsArray) {
+            error = "배열 형식의 model.vocab은 지원하지 않습니다.";
+            return false;
+        }
+
         // 디코더 타입 감지 (Metaspace 면 SentencePiece, WordPiece 면 WordPiece)
-        if (tokenizer.contains("decoder") && tokenizer["decoder"].contains("type")) {
-            decoderType = tokenizer["decoder"]["type"].get<std::string>();
+        if (!handler.hasDecoderType) {
+            error = "tokenizer.json에 decoder.type이 정의되지 않음.";
+            return false;
         }
-        else {
-            std::cerr << "Error: tokenizer.json에 decoder.type이 정의되지 않음.\n";
-            exit(1);
+        // UNK 토큰 확인
+        const char* names[3];
+        if (handler.hasUnkToken && handler.unkToken == "<unk>") {
+            // sentencepiece인 경우
+            names[0] = "<unk>"; names[1] = "<s>"; names[2] = "</s>";
+        } else if (handler.hasUnkToken && handler.unkToken == "[UNK]") {
+            names[0] = "[UNK]"; names[1] = "[CLS]"; names[2] = "[SEP]";
+        } else {
+            error = "none type in tokenizer.json.";
+            return false;
         }
-    
+
+        decoderType = handler.decoderType;
+
         // `replacement` 또는 `prefix` 값 가져오기
-        if (decoderType == "Metaspace" && tokenizer["decoder"].contains("replacement")) {
-            subwordPrefix = tokenizer["decoder"]["replacement"].get<std::string>();
+        if (decoderType == "Metaspace" && handler.hasReplacement) {
+            subwordPrefix = handler.replacement;
         }
-        else if (decoderType == "WordPiece" && tokenizer["decoder"].contains("prefix")) {
-            subwordPrefix = tokenizer["decoder"]["prefix"].get<std::string>();
+        else if (decoderType == "WordPiece" && handler.hasPrefix) {
+            subwordPrefix = handler.prefix;
         }
         else {
             subwordPrefix = (decoderType == "Metaspace") ? "?" : "##";  // 기본값 설정
         }
-    
-        // UNK 토큰 확인
-        if (tokenizer["model"].contains("unk_token")) {
-            // sentencepiece인 경우
-            if( tokenizer["model"]["unk_token"].get<std::string>() == "<unk>" ) {
-                for (const auto& token : tokenizer["added_tokens"]) {
-                    if (token["content"] == "<unk>") {
-                        unkToken = token["content"].get<std::string>();
-                        unkId = token["id"].get<int>();
-                    } else if (token["content"] == "<s>") {
-                        startToken = token["content"].get<std::string>();
-                        startId = token["id"].get<int>();
-                    } else if (token["content"] == "</s>") {
-                        endToken = token["content"].get<std::string>();
-                        endId = token["id"].get<int>();
-                    }
-                }
-            } else if ( tokenizer["model"]["unk_token"].get<std::string>() == "[UNK]" ) {
-                for (const auto& token : tokenizer["added_tokens"]) {
-                    if (token["content"] == "[UNK]") {
-                        unkToken = token["content"].get<std::string>();
-                        unkId = token["id"].get<int>();
-                    } else if (token["content"] == "[CLS]") {
-                        startToken = token["content"].get<std::string>();
-                        startId = token["id"].get<int>();
-                    } else if (token["content"] == "[SEP]") {
-                        endToken = token["content"].get<std::string>();
-                        endId = token["id"].get<int>();
-                    }
-                }
-            } else {
-                std::cerr << "Error: none type in tokenizer.json.\n";
-                exit(1);
-            }
-        }
-        else {
-            std::cerr << "Error: none type in tokenizer.json.\n";
-            exit(1);
-        }
-    
-        size_t vocabSize = tokenizer["model"]["vocab"].size();
-        size_t estimatedNodes = vocabSize * 3;
-        //printf("subprefix: %s\n", subwordPrefix.c_str());
-        //printf("vocab size: %zu\n", vocabSize);
-    
-        delete nodePool;
-        nodePool = new MemoryPool(estimatedNodes);
-        root = nodePool->allocate();
-    
-        // ID -> 토큰 맵과 토큰 -> ID 맵 초기화
-        idToTokenMap.clear();
-        tokenToIdMap.clear();
-        idToTokenMap.reserve(vocabSize);
-        tokenToIdMap.reserve(vocabSize);
-    
-        // 기본 어휘 로드
-        for (auto it = tokenizer["model"]["vocab"].begin(); it != tokenizer["model"]["vocab"].end(); ++it) {
-            std::string token = it.key();
-            int token_id = it.value().get<int>();
-    
-            // 특수 토큰 여부 확인 (기본적으로 모두 일반 토큰으로 설정)
-            bool isSpecial = false;
-            
-            // 양방향 매핑 추가
-            idToTokenMap[token_id] = TokenInfo(token, isSpecial);
-            tokenToIdMap[token] = token_id;
-    
-            TrieNode* current = root;
-    
-            for (unsigned char ch : token) {
-                if (!current->children[ch]) {
-                    current->children[ch] = nodePool->allocate();
-                }
-                current = current->children[ch];
+
+        for (const auto& token : handler.addedTokens) {
+            if (!token.hasContent || !token.hasId) continue;
+            if (token.content == names[0]) {
+                unkToken = token.content;
+                unkId = token.id;
+            } else if (token.content == names[1]) {
+                startToken = token.content;
+                startId = token.id;
+            } else if (token.content == names[2]) {
+                endToken = token.content;
+                endId = token.id;
             }
-            current->isEnd = true;
-            current->id = token_id;
-            current->isSpecial = isSpecial;
         }
         
         // added_tokens에서 special=true 토큰 설정
-        if (tokenizer.contains("added_tokens")) {
-            for (const auto& token : tokenizer["added_tokens"]) {
-                if (token.contains("content") && token.contains("id") && token.contains("special")) {
-                    std::string tokenContent = token["content"].get<std::string>();
-                    int tokenId = token["id"].get<int>();
-                    bool isSpecial = token["special"].get<bool>();
-                    
-                    if (isSpecial) {
-                        // 이미 등록된 토큰이면 특수 토큰으로 표시
-                        auto idIt = idToTokenMap.find(tokenId);
-                        if (idIt != idToTokenMap.end()) {
-                            idIt->second.isSpecial = true;
-                        } else {
-                            // 새 토큰이면 추가
-                            idToTokenMap[tokenId] = TokenInfo(tokenContent, true);
-                            tokenToIdMap[tokenContent] = tokenId;
-                        }
-                        
-                        // Trie에도 설정
-                        TrieNode* current = root;
-                        for (unsigned char ch : tokenContent) {
-                            if (!current->children[ch]) {
-                                current->children[ch] = nodePool->allocate();
-                            }
-                            current = current->children[ch];
-                        }
-                        current->isEnd = true;
-                        current->id = tokenId;
-                        current->isSpecial = true;
-                    }
+        for (const auto& token : handler.addedTokens) {
+            if (token.hasContent && token.hasId && token.hasSpecial) {
+                const std::string& tokenContent = token.content;
+                int tokenId = token.id;
+                bool isSpecial = token.special;
+                
+                if (isSpecial) {
+                    // Trie에 설정 (ID 맵에서는 이미 등록된 ID면 특수 토큰으로 표시만 함, buildDecodeTables)
+                    tokens.add(tokenContent, tokenId, true);
                 }
             }
         }
         
         // 시작, 종료, UNK 토큰을 특수 토큰으로 설정
-        // idToTokenMap에 설정
-        auto startIt = idToTokenMap.find(startId);
-        if (startIt != idToTokenMap.end()) {
-            startIt->second.isSpecial = true;
-        } else {
-            idToTokenMap[startId] = TokenInfo(startToken, true);
-            tokenToIdMap[startToken] = startId;
+        tokens.add(startToken, startId, true); // 시작 토큰
+        tokens.add(endToken, endId, true);     // 종료 토큰
+        tokens.add(unkToken, unkId, true);     // UNK 토큰
+
+        // ID 테이블에 넣을 수 없는 ID는 디코드할 때 조용히 빠지므로 로드할 때 알림
+        if (decodeTables) {
+            const size_t idCap = decodeIdCap(tokens.entries.size());
+            size_t dropped = 0;
+            for (const TokenList::Entry& e : tokens.entries) {
+                if (e.id != -1 && (e.id < 0 || static_cast<size_t>(e.id) >= idCap)) ++dropped;
+            }
+            if (dropped > 0) {
+                std::cerr << "Warning: ID가 음수이거나 " << idCap << " 이상인 토큰 " << dropped
+                          << "개는 ID -> 토큰 변환(decode, convert_ids_to_tokens)에서 제외됩니다.\n";
+            }
         }
-        
-        auto endIt = idToTokenMap.find(endId);
-        if (endIt != idToTokenMap.end()) {
-            endIt->second.isSpecial = true;
-        } else {
-            idToTokenMap[endId] = TokenInfo(endToken, true);
-            tokenToIdMap[endToken] = endId;
+
+        maxTokenLength = 0;
+        trieEngine = engineSetting;
+        interleaved = interleavedSetting;
+
+        // ID -> 토큰 테이블과 토큰 -> ID 해시 초기화 (디코드/변환 시 tokens의 사본으로 만듦)
+        idTable.clear();
+        tokenHash.clear();
+        vocabBlob.clear();
+        vocabBlob.shrink_to_fit();
+        decodeSource = TokenList();
+        decodeTablesOnce.reset();
+
+        // 정렬된 토큰으로 빌드용 TrieNode 트리를 병렬 구성한 뒤 검색용 Trie로 변환 (둘 다 함수 종료 시 해제)
+        MemoryPool nodePool(0);
+        nodePool.allocate(); // 0번: 루트
+        if (decodeTables) decodeSource.entries = tokens.entries; // 정렬 전 순서 (맵은 나중 항목이 우선)
+        buildTokenTrie(tokens, nodePool);
+        if (decodeTables) {
+            decodeSource.blob.swap(tokens.blob);
+            decodeTablesOnce.reset(new std::once_flag);
         }
-        
-        auto unkIt = idToTokenMap.find(unkId);
-        if (unkIt != idToTokenMap.end()) {
-            unkIt->second.isSpecial = true;
-        } else {
-            idToTokenMap[unkId] = TokenInfo(unkToken, true);
-            tokenToIdMap[unkToken] = unkId;
+        tokens = TokenList(); // 검색용 Trie 변환 전에 토큰 목록 해제
+        buildSearchTrie(nodePool);
+        cacheStartStates();
+        compiledImage.reset(); // 이전 loadCompiled 이미지를 더 이상 참조하지 않음
+        return true;
+    }
+
+public:
+
+    /**
+     * 로드된 토크나이저(완성된 검색용 Trie, ID 테이블, 특수 토큰 정보)를
+     * 버전과 체크섬이 있는 평면 파일로 저장합니다. loadCompiled로 다시 읽습니다.
+     * @param filename 출력 파일 경로
+     * @return 성공 여부
+     */
+    bool saveCompiled(const std::string& filename) const {
+        bool loaded = false;
+        withTrie([&loaded](const auto& t) { loaded = !t.empty(); });
+        if (!loaded) {
+            std::cerr << "Error: 저장할 토크나이저가 로드되지 않았습니다.\n";
+            return false;
         }
-        
-        // Trie에도 설정
-        // 시작 토큰
-        TrieNode* current = root;
-        for (unsigned char ch : startToken) {
-            if (!current->children[ch]) {
-                current->children[ch] = nodePool->allocate();
-            }
-            current = current->children[ch];
-        }
-        current->isEnd = true;
-        current->id = startId;
-        current->isSpecial = true;
-        
-        // 종료 토큰
-        current = root;
-        for (unsigned char ch : endToken) {
-            if (!current->children[ch]) {
-                current->children[ch] = nodePool->allocate();
-            }
-            current = current->children[ch];
+
+        CompiledMeta meta;
+        std::memset(&meta, 0, sizeof(meta));
+        meta.engine = static_cast<uint32_t>(trieEngine);
+        meta.unkId = unkId;
+        meta.startId = startId;
+        meta.endId = endId;
+        meta.maxTokenLength = maxTokenLength;
+        meta.wordStartState = wordStartState;
+        meta.wordStartPrefixId = wordStartPrefixId;
+        meta.continuationState = continuationState;
+        meta.flags = (hasWordStartState ? 1u : 0u) | (hasContinuationState ? 2u : 0u);
+
+        const std::string* strings[5] = { &decoderType, &unkToken, &startToken, &endToken, &subwordPrefix };
+        std::string stringBlob;
+        for (int i = 0; i < 5; ++i) {
+            meta.stringLength[i] = static_cast<uint32_t>(strings[i]->size());
+            stringBlob += *strings[i];
         }
-        current->isEnd = true;
-        current->id = endId;
-        current->isSpecial = true;
-        
-        // UNK 토큰
-        current = root;
-        for (unsigned char ch : unkToken) {
-            if (!current->children[ch]) {
-                current->children[ch] = nodePool->allocate();
+
+        // ID 테이블, 토큰 -> ID 해시와 둘이 공유하는 토큰 문자열 blob
+        // (매핑된 이미지에서 로드했으면 그 테이블을 그대로 기록)
+        if (!hasVocabTables()) {
+            std::cerr << "Error: setDecodeTables(false)로 로드하여 어휘 테이블을 저장할 수 없습니다.\n";
+            return false;
+        }
+        ensureDecodeTables();
+
+        CompiledWriter writer;
+        writer.addValue(CompiledTag('M', 'E', 'T', 'A'), meta);
+        writer.add(CompiledTag('S', 'T', 'R', 'S'), stringBlob.data(), stringBlob.size());
+        idTable.save(writer);
+        tokenHash.save(writer);
+        writer.add(CompiledTag('V', 'C', 'B', 'L'), tokenHash.blobBegin(), tokenHash.blobLength());
+        withTrie([&writer](const auto& t) { t.save(writer); });
+        linMaxMatch.save(writer);
+        rootTable.save(writer, CompiledTag('F', 'L', 'T', '0'));
+        startTable.save(writer, CompiledTag('F', 'L', 'T', '1'));
+
+        if (!writer.write(filename)) {
+            std::cerr << "Error: 컴파일된 토크나이저 파일을 쓸 수 없습니다: " << filename << "\n";
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * saveCompiled로 저장한 파일을 메모리 매핑하여 로드합니다.
+     * Trie 배열과 테이블은 복사 없이 매핑된 메모리를 직접 가리키며,
+     * 검색용 Trie 엔진은 파일에 저장된 엔진으로 바뀝니다.
+     * 파일이 손상되었거나 버전이 다르면 기존 상태를 유지하고 false를 반환합니다.
+     * @param filename 컴파일된 토크나이저 파일 경로
+     * @return 성공 여부
+     */
+    bool loadCompiled(const std::string& filename) {
+        std::string error;
+        if (!attachCompiled(filename, error)) {
+            std::cerr << "Error: " << error << "\n";
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * 여러 프로세스가 같은 토크나이저를 물리 메모리 한 벌로 공유하도록 로드합니다.
+     * tokenizer.json 경로, 크기, 수정 시각, Trie 엔진으로 정한 이름의 컴파일된 이미지를
+     * 공유 디렉터리(/dev/shm 등)에서 찾아 매핑하고, 없으면 한 번 빌드해 저장한 뒤 매핑합니다.
+     * 이미지의 페이지는 페이지 캐시에 한 벌만 있으므로 추가 작업 프로세스의 RSS는 거의 늘지 않습니다.
+     * 이미지를 저장하거나 매핑할 수 없으면 경고 후 일반 로드 결과(프로세스 전용 사본)를 유지합니다.
+     * 파일이 없거나 올바르지 않으면 종료하지 않고 기존 상태를 유지한 채 SharedLoad::Failed를 반환합니다.
+     * 이미지는 자동으로 지워지지 않으므로 tokenizer.json이나 엔진을 바꾼 뒤에는 removeShared로 정리합니다.
+     * @param filename tokenizer.json 파일 경로
+     * @param directory 이미지를 둘 디렉터리 (비어 있으면 CompiledSharedDirectory())
+     * @return 공유 이미지 사용(Shared), 전용 사본 사용(Private), 로드 실패(Failed)
+     */
+    SharedLoad loadShared(const std::string& filename, const std::string& directory = "") {
+        const std::string path = sharedImagePath(filename, directory);
+        if (path.empty()) {
+            std::cerr << "Error: tokenizer.json 파일을 열 수 없습니다.\n";
+            return SharedLoad::Failed;
+        }
+
+        // 다른 프로세스가 이미 만들어 둔 이미지가 있으면 그대로 매핑
+        std::string error;
+        if (attachCompiled(path, error)) return SharedLoad::Shared;
+
+        // 없거나 손상되었으면 빌드 후 임시 파일에 저장하고 이름을 바꿔 원자적으로 게시
+        if (!tryLoadTokenizer(filename)) return SharedLoad::Failed;
+        const std::string temporary = path + "." + std::to_string(CompiledProcessId()) + ".tmp";
+        if (!saveCompiled(temporary)) {
+            std::remove(temporary.c_str());
+            std::cerr << "Warning: 공유 토크나이저 이미지를 만들 수 없어 전용 사본을 사용합니다: " << path << "\n";
+            return SharedLoad::Private;
+        }
+        if (!CompiledReplaceFile(temporary, path)) {
+            std::remove(temporary.c_str());
+            std::cerr << "Warning: 공유 토크나이저 이미지를 게시할 수 없어 전용 사본을 사용합니다: " << path << "\n";
+            return SharedLoad::Private;
+        }
+        if (!attachCompiled(path, error)) {
+            std::cerr << "Warning: " << error << " (전용 사본을 사용합니다)\n";
+            return SharedLoad::Private;
+        }
+        return SharedLoad::Shared;
+    }
+
+    /**
+     * loadShared가 만든 공유 이미지를 지웁니다. (setTrieEngine으로 정한 엔진 기준)
+     * 이미 매핑한 프로세스는 계속 사용할 수 있고, 다음 loadShared는 이미지를 다시 만듭니다.
+     * (Windows에서는 매핑 중인 이미지를 지울 수 없어 false를 반환합니다)
+     * @param filename tokenizer.json 파일 경로
+     * @param directory 이미지를 둔 디렉터리 (비어 있으면 CompiledSharedDirectory())
+     * @return 이미지를 지웠으면 true
+     */
+    bool removeShared(const std::string& filename, const std::string& directory = "") const {
+        const std::string path = sharedImagePath(filename, directory);
+        return !path.empty() && std::remove(path.c_str()) == 0;
+    }
+
+    /**
+     * loadShared가 사용하는 공유 이미지 경로를 구합니다. (setTrieEngine으로 정한 엔진 기준)
+     * @param filename tokenizer.json 파일 경로
+     * @param directory 이미지를 둘 디렉터리 (비어 있으면 CompiledSharedDirectory())
+     * @return 이미지 경로 (tokenizer.json을 찾을 수 없으면 빈 문자열)
+     */
+    std::string sharedImagePath(const std::string& filename, const std::string& directory = "") const {
+        uint64_t fileSize;
+        int64_t modified;
+        if (!CompiledFileStat(filename, fileSize, modified)) return "";
+
+        char name[64];
+        std::string key = CompiledAbsolutePath(filename);
+        key.append(reinterpret_cast<const char*>(&fileSize), sizeof(fileSize));
+        key.append(reinterpret_cast<const char*>(&modified), sizeof(modified));
+        const uint32_t keyTail[2] = { static_cast<uint32_t>(engineSetting), COMPILED_VERSION };
+        key.append(reinterpret_cast<const char*>(keyTail), sizeof(keyTail));
+        std::snprintf(name, sizeof(name), "nemo_tokenizer_%016llx.bin",
+                      static_cast<unsigned long long>(CompiledChecksum(key.data(), key.size())));
+        return (directory.empty() ? CompiledSharedDirectory() : directory) + "/" + name;
+    }
+
+    /**
+     * 바이너리에 링크된 컴파일된 이미지를 복사 없이 로드합니다. (파일 입출력 없음)
+     * nemo_embed가 만든 배열(embedded_tokenizer.h의 nemoEmbeddedImageData)을 넘기며, 배열은 프로세스가 끝날 때까지 유지되어야 합니다.
+     * 링크된 이미지는 손상될 수 없으므로 체크섬은 확인하지 않아 쓰지 않는 페이지를 읽지 않습니다.
+     * @param data 이미지 시작 (64바이트 정렬)
+     * @param size 이미지 바이트 수
+     * @return 성공 여부 (실패하면 기존 상태 유지)
+     */
+    bool loadEmbedded(const unsigned char* data, size_t size) {
+        const char* image = reinterpret_cast<const char*>(data);
+        CompiledReader reader;
+        std::string error;
+        if (reinterpret_cast<uintptr_t>(image) % COMPILED_ALIGNMENT != 0) {
+            error = "링크된 토크나이저 이미지가 64바이트 정렬되어 있지 않습니다.";
+        } else if (!reader.open(image, size, false)) {
+            error = "링크된 토크나이저 이미지가 올바르지 않거나 버전이 다릅니다.";
+        } else if (attachImage(std::shared_ptr<const void>(image, [](const void*) {}), reader, error)) {
+            return true;
+        }
+        std::cerr << "Error: " << error << "\n";
+        return false;
+    }
+
+private:
+    /**
+     * 컴파일된 이미지를 매핑하여 현재 토크나이저를 교체합니다.
+     * 실패하면 기존 상태를 유지하고 error에 이유를 기록합니다.
+     */
+    bool attachCompiled(const std::string& filename, std::string& error) {
+        std::shared_ptr<MappedFile> image = std::make_shared<MappedFile>();
+        CompiledReader reader;
+        if (!image->open(filename)) {
+            error = "컴파일된 토크나이저 파일을 열 수 없습니다: " + filename;
+            return false;
+        }
+        if (!reader.open(image->data(), image->size())) {
+            error = "컴파일된 토크나이저 파일이 손상되었거나 버전이 다릅니다: " + filename;
+            return false;
+        }
+        return attachImage(image, reader, error);
+    }
+
+    /**
+     * 검증된 이미지의 섹션을 연결하여 현재 토크나이저를 교체합니다.
+     * @param image 섹션 메모리의 소유자 (토크나이저가 이미지를 쓰는 동안 유지)
+     * @param reader image를 연 CompiledReader
+     * @param error 실패 이유
+     * @return 성공 여부 (실패하면 기존 상태 유지)
+     */
+    bool attachImage(std::shared_ptr<const void> image, const CompiledReader& reader, std::string& error) {
+        CompiledMeta meta;
+        const char* stringBlob;
+        size_t stringSize;
+        if (!reader.getValue(CompiledTag('M', 'E', 'T', 'A'), meta)
+            || meta.engine > static_cast<uint32_t>(TrieEngine::Radix)
+            || !reader.get(CompiledTag('S', 'T', 'R', 'S'), stringBlob, stringSize)) {
+            error = "컴파일된 토크나이저 메타데이터가 올바르지 않습니다.";
+            return false;
+        }
+
+        std::string strings[5];
+        size_t stringOffset = 0;
+        for (int i = 0; i < 5; ++i) {
+            if (meta.stringLength[i] > stringSize - stringOffset) {
+                error = "컴파일된 토크나이저 메타데이터가 올바르지 않습니다.";
+                return false;
             }
-            current = current->children[ch];
+            strings[i].assign(stringBlob + stringOffset, meta.stringLength[i]);
+            stringOffset += meta.stringLength[i];
+        }
+
+        // 검색용 Trie와 테이블을 지역 객체에 연결한 뒤 모두 성공하면 교체
+        const TrieEngine engine = static_cast<TrieEngine>(meta.engine);
+        DoubleArrayTrie newTrie;
+        FrozenTrie newFrozenTrie;
+        ByteClassTrie newDenseTrie;
+        RadixTrie newRadixTrie;
+        bool attached = false;
+        size_t stateSpace = 0;
+        switch (engine) {
+        case TrieEngine::Frozen: attached = newFrozenTrie.attach(reader); stateSpace = newFrozenTrie.size(); break;
+        case TrieEngine::Dense: attached = newDenseTrie.attach(reader); stateSpace = newDenseTrie.size(); break;
+        case TrieEngine::Radix: attached = newRadixTrie.attach(reader); stateSpace = newRadixTrie.size(); break;
+        default: attached = newTrie.attach(reader); stateSpace = newTrie.size(); break;
+        }
+
+        LinMaxMatch newLinMaxMatch;
+        FirstLevelTable newRootTable;
+        FirstLevelTable newStartTable;
+        if (!attached || !newLinMaxMatch.attach(reader, stateSpace)
+            || !newRootTable.attach(reader, CompiledTag('F', 'L', 'T', '0'))
+            || !newStartTable.attach(reader, CompiledTag('F', 'L', 'T', '1'))) {
+            error = "컴파일된 토크나이저의 Trie 섹션이 올바르지 않습니다.";
+            return false;
+        }
+
+        const char* tokenBlob;
+        size_t blobSize;
+        if (!reader.get(CompiledTag('V', 'C', 'B', 'L'), tokenBlob, blobSize)) {
+            error = "컴파일된 토크나이저의 어휘 섹션이 없습니다.";
+            return false;
+        }
+
+        // 어휘 테이블은 다시 만들지 않고 매핑된 이미지에서 바로 색인/해시 조회
+        IdTokenTable newIdTable;
+        TokenIdHash newTokenHash;
+        if (!newIdTable.attach(reader, tokenBlob, blobSize) || !newTokenHash.attach(reader, tokenBlob, blobSize)) {
+            error = "컴파일된 토크나이저의 어휘 섹션이 올바르지 않습니다.";
+            return false;
         }
-        current->isEnd = true;
-        current->id = unkId;
-        current->isSpecial = true;
+
+        trieEngine = engine;
+        interleaved = interleavedSetting;
+        trie = std::move(newTrie);
+        frozenTrie = std::move(newFrozenTrie);
+        denseTrie = std::move(newDenseTrie);
+        radixTrie = std::move(newRadixTrie);
+        linMaxMatch = std::move(newLinMaxMatch);
+        rootTable = std::move(newRootTable);
+        startTable = std::move(newStartTable);
+        idTable = std::move(newIdTable);
+        tokenHash = std::move(newTokenHash);
+        vocabBlob.clear();
+        vocabBlob.shrink_to_fit();
+        decodeSource = TokenList();
+        decodeTablesOnce.reset();
+
+        decoderType = strings[0];
+        unkToken = strings[1];
+        startToken = strings[2];
+        endToken = strings[3];
+        subwordPrefix = strings[4];
+        unkId = meta.unkId;
+        startId = meta.startId;
+        endId = meta.endId;
+        maxTokenLength = static_cast<size_t>(meta.maxTokenLength);
+        wordStartState = meta.wordStartState;
+        wordStartPrefixId = meta.wordStartPrefixId;
+        continuationState = meta.continuationState;
+        hasWordStartState = (meta.flags & 1) != 0;
+        hasContinuationState = (meta.flags & 2) != 0;
+        compiledImage = std::move(image);
+        return true;
     }
 
+public:
+
     /**
      * 텍스트를 토큰으로 분리합니다.
      * @param text 토큰화할 텍스트
@@ -443,86 +2160,13 @@ public:
     std::vector<std::string> tokenize(const std::string& text, bool add_special_tokens = true) const {
         std::vector<std::string> tokens;
         tokens.reserve(text.length() / 2);
-        std::vector<std::string> words = splitWords(text);
-
-        // 임시 버퍼를 한 번만 할당하여 재사용
-        std::string buffer;
-        buffer.reserve(text.length());
 
         if (add_special_tokens) {
             tokens.emplace_back(startToken);  // 시작 토큰 추가
         }
 
-        for (const auto& word : words) {
-            // 입력 준비 (WordPiece 또는 SentencePiece에 따라 다름)
-            const char* input_ptr;
-            size_t input_offset = 0;
-            size_t input_length;
-            
-            if (decoderType == "WordPiece") {
-                input_ptr = word.c_str();
-                input_length = word.length();
-            } else {
-                // SentencePiece인 경우 prefix 추가
-                buffer.clear();
-                buffer = subwordPrefix;
-                buffer.append(word);
-                input_ptr = buffer.c_str();
-                input_length = buffer.length();
-            }
-            
-            size_t position = 0;
-            bool isSubword = false;
-
-            while (position < input_length) {
-                size_t remaining = input_length - position;
-                int matchedId = -1;
-                int matchedLen = 0;
-
-                // Trie 순회
-                TrieNode* current = root;
-                if (isSubword && decoderType == "WordPiece") { // wordpiece이고 단어 중간에 끊긴 경우 ##만큼 node 2번 이동
-                    unsigned char ch = subwordPrefix[0];
-                    if (!current->children[ch]) break;
-                    current = current->children[ch];
-                    ch = subwordPrefix[1];
-                    if (!current->children[ch]) break;
-                    current = current->children[ch];
-                }
-
-                for (size_t i = 0; i < remaining; ++i) {
-                    unsigned char ch = static_cast<unsigned char>(input_ptr[position + i]);
-                    if (!current->children[ch]) break;
-                    current = current->children[ch];
-                    if (current->isEnd) {
-                        matchedId = current->id;
-                        matchedLen = i + 1;
-                    }
-                }
-
-                if (matchedId != -1) {
-                    // 직접 메모리에서 토큰 생성 (복사 최소화)
-                    if (isSubword && decoderType == "WordPiece") {
-                        tokens.emplace_back(subwordPrefix + std::string(input_ptr + position, matchedLen));
-                    } else tokens.emplace_back(input_ptr + position, matchedLen);
-                    position += matchedLen;
-                    isSubword = true;
-                } else {
-                    // UNK 토큰은 한 번만 복사
-                    tokens.push_back(unkToken);
-
-                    // UTF-8 문자 바이트 크기 계산
-                    unsigned char c = input_ptr[position];
-                    int byteCount = ((c & 0x80) == 0) ? 1 :
-                                    ((c & 0xE0) == 0xC0) ? 2 :
-                                    ((c & 0xF0) == 0xE0) ? 3 :
-                                    ((c & 0xF8) == 0xF0) ? 4 : 1;
-
-                    position += std::min(static_cast<size_t>(byteCount), remaining);
-                    isSubword = true;
-                }
-            }
-        }
+        TokenSink sink(tokens, subwordPrefix, unkToken);
+        withTrie([&](const auto& t) { matchText(t, text.data(), text.length(), sink); });
 
         if (add_special_tokens) {
             tokens.emplace_back(endToken);  // 종료 토큰 추가
@@ -555,92 +2199,222 @@ public:
      * @return 토큰 ID 리스트
      */
     std::vector<int> encode(const std::string& text, bool add_special_tokens = true) const {
+        return encode(text.data(), text.length(), add_special_tokens);
+    }
+
+    std::vector<int> encode(const char* text, size_t textLength, bool add_special_tokens = true) const {
         std::vector<int> ids;
-        ids.reserve(text.length() / 2 + (add_special_tokens ? 2 : 0)); // 평균 토큰 길이를 2로 가정하고 공간 예약
-        std::vector<std::string> words = splitWords(text);
+        ids.reserve(textLength / 2 + (add_special_tokens ? 2 : 0)); // 평균 토큰 길이를 2로 가정하고 공간 예약
         
         if (add_special_tokens) {
             ids.emplace_back(startId);  // 시작 토큰 추가
         }
         
-        // 임시 버퍼를 한 번만 할당하여 재사용
-        std::string buffer;
-        buffer.reserve(text.length());
+        // 단어 분리와 매칭을 한 번에 수행 (출력 ids 외에는 할당 없음)
+        IdSink sink(ids, unkId);
+        withTrie([&](const auto& t) { matchText(t, text, textLength, sink); });
         
-        for (const auto& word : words) {
-            // 입력 준비 (WordPiece 또는 SentencePiece에 따라 다름)
-            const char* input_ptr;
-            size_t input_length;
-            
-            if (decoderType == "WordPiece") {
-                input_ptr = word.c_str();
-                input_length = word.length();
-            } else {
-                // SentencePiece인 경우 prefix 추가
-                buffer.clear();
-                buffer = subwordPrefix;
-                buffer.append(word);
-                input_ptr = buffer.c_str();
-                input_length = buffer.length();
+        if (add_special_tokens) {
+            ids.push_back(endId);  // 종료 토큰 추가
+        }
+        
+        return ids;
+    }
+
+    /**
+     * 텍스트를 토큰 ID로 변환하여 호출자가 준비한 버퍼에 씁니다. (할당 없음)
+     * 버퍼가 모자라면 앞의 capacity개만 쓰고 전체 개수를 반환하므로,
+     * 반환값이 capacity보다 크면 그만큼의 버퍼로 다시 호출하면 됩니다.
+     * @param text 변환할 텍스트 (UTF-8)
+     * @param textLength 텍스트 바이트 길이
+     * @param out ID를 쓸 버퍼
+     * @param capacity 버퍼에 들어가는 ID 개수
+     * @param add_special_tokens 특수 토큰(시작, 종료) 추가 여부
+     * @return 텍스트의 전체 토큰 ID 개수 (쓴 개수는 이 값과 capacity 중 작은 값)
+     */
+    size_t encode_into(const char* text, size_t textLength, int32_t* out, size_t capacity, bool add_special_tokens = true) const {
+        BufferSink sink(out, capacity, unkId);
+        if (add_special_tokens) {
+            sink.put(startId);
+        }
+        withTrie([&](const auto& t) { matchText(t, text, textLength, sink); });
+        if (add_special_tokens) {
+            sink.put(endId);
+        }
+        return sink.count;
+    }
+
+    size_t encode_into(const std::string& text, int32_t* out, size_t capacity, bool add_special_tokens = true) const {
+        return encode_into(text.data(), text.length(), out, capacity, add_special_tokens);
+    }
+
+    /**
+     * 여러 텍스트를 토큰 ID로 변환하여 하나의 평면 배열(CSR)로 반환합니다.
+     * 스레드마다 맡은 문서의 ID를 자기 버퍼 하나에 이어 쓰고, 문서별 개수로 오프셋을 계산한 뒤
+     * 각 문서를 결과 배열의 정해진 구간에 병렬로 복사하므로 문서 수와 무관하게 할당 횟수가 일정합니다.
+     * 텍스트를 두 번 토큰화하지 않는 대신 복사하는 동안에는 ID 배열 크기의 메모리가 두 배로 필요합니다.
+     * OpenMP 기본 스레드 수를 사용합니다. (OMP_NUM_THREADS 등 호출한 쪽 설정을 바꾸지 않음)
+     * @param texts 변환할 텍스트 (UTF-8) 포인터 배열
+     * @param lengths 각 텍스트의 바이트 길이
+     * @param count 텍스트 수
+     * @param add_special_tokens 특수 토큰(시작, 종료) 추가 여부
+     * @return 이어 붙인 ID 배열과 문서 경계 오프셋
+     */
+    EncodedBatch batch_encode(const char* const* texts, const size_t* lengths, size_t count, bool add_special_tokens = true) const {
+        EncodedBatch batch;
+        batch.offsets.assign(count + 1, 0);
+        if (count == 0) return batch;
+
+        const int threadCount = omp_get_max_threads();
+        std::vector<std::vector<int>> local(threadCount);
+        size_t totalLength = 0;
+        for (size_t i = 0; i < count; ++i) totalLength += lengths[i];
+        std::vector<int> owner(count);     // 문서를 처리한 스레드
+        std::vector<size_t> position(count); // 그 스레드 버퍼에서의 시작 위치
+
+        #pragma omp parallel
+        {
+            const int thread = omp_get_thread_num();
+            std::vector<int>& ids = local[thread];
+            // 평균 토큰 길이를 2로 가정하여 스레드 몫만큼 미리 예약 (재할당 줄임)
+            const size_t estimate = totalLength / 2 + (add_special_tokens ? count * 2 : 0);
+            ids.reserve(estimate / static_cast<size_t>(omp_get_num_threads()) + 16);
+            IdSink sink(ids, unkId);
+            #pragma omp for schedule(dynamic, 1)
+            for (int i = 0; i < static_cast<int>(count); ++i) {
+                const size_t start = ids.size();
+                if (add_special_tokens) ids.push_back(startId);
+                withTrie([&](const auto& t) { matchText(t, texts[i], lengths[i], sink); });
+                if (add_special_tokens) ids.push_back(endId);
+                owner[i] = thread;
+                position[i] = start;
+                batch.offsets[i + 1] = static_cast<int64_t>(ids.size() - start);
             }
-            
-            size_t position = 0;
-            bool isSubword = false;
+        }
 
-            while (position < input_length) {
-                size_t remaining = input_length - position;
-                int matchedId = -1;
-                int matchedLen = 0;
-
-                // Trie 순회
-                TrieNode* current = root;
-                if (isSubword && decoderType == "WordPiece") // wordpiece이고 단어 중간에 끊긴 경우 ##만큼 node 2번 이동
-                {
-                    unsigned char ch = subwordPrefix[0];
-                    if (!current->children[ch]) break;
-                    current = current->children[ch];
-                    ch = subwordPrefix[1];
-                    if (!current->children[ch]) break;
-                    current = current->children[ch];
-                }
+        // 문서별 개수를 누적하여 오프셋으로 바꾸고 결과 배열을 한 번에 할당
+        for (size_t i = 0; i < count; ++i) {
+            batch.offsets[i + 1] += batch.offsets[i];
+        }
+        batch.ids.resize(static_cast<size_t>(batch.offsets[count]));
 
-                for (size_t i = 0; i < remaining; ++i) {
-                    unsigned char ch = static_cast<unsigned char>(input_ptr[position + i]);
-                    if (!current->children[ch]) break;
-                    current = current->children[ch];
-                    if (current->isEnd) {
-                        matchedId = current->id;
-                        matchedLen = i + 1;
-                    }
-                }
+        #pragma omp parallel for schedule(static)
+        for (int i = 0; i < static_cast<int>(count); ++i) {
+            const size_t length = static_cast<size_t>(batch.offsets[i + 1] - batch.offsets[i]);
+            if (length) std::memcpy(&batch.ids[batch.offsets[i]], &local[owner[i]][position[i]], length * sizeof(int32_t));
+        }
+        return batch;
+    }
+
+    EncodedBatch batch_encode(const std::vector<std::string>& texts, bool add_special_tokens = true) const {
+        std::vector<const char*> pointers(texts.size());
+        std::vector<size_t> lengths(texts.size());
+        for (size_t i = 0; i < texts.size(); ++i) {
+            pointers[i] = texts[i].data();
+            lengths[i] = texts[i].length();
+        }
+        return batch_encode(pointers.data(), lengths.data(), texts.size(), add_special_tokens);
+    }
+
+    /**
+     * 패딩 토큰 ID를 찾습니다. (WordPiece "[PAD]", SentencePiece "<pad>", 검색 Trie에서 조회)
+     * @return 패딩 토큰 ID, 어휘에 없으면 0
+     */
+    int padTokenId() const {
+        const std::string padToken = (unkToken == "<unk>") ? "<pad>" : "[PAD]";
+        int id = -1;
+        withTrie([&](const auto& t) {
+            uint32_t current;
+            if (findState(t, padToken, current)) id = t.value(current);
+        });
+        return (id == -1) ? 0 : id;
+    }
+
+    /**
+     * 여러 텍스트를 토큰 ID로 변환하여 길이를 맞춘 [문서 수, 길이] 배열로 반환합니다.
+     * 길이를 미리 알 수 있으면(truncation + padToMaxLength) 각 행에 바로 인코딩하고,
+     * 그렇지 않으면 batch_encode로 한 번 인코딩하여 가장 긴 문서 길이를 구한 뒤 행에 복사합니다.
+     * 세 결과 배열은 한 번씩만 할당하며 행은 기본 OpenMP 스레드 수로 병렬로 채웁니다.
+     * @param texts 변환할 텍스트 (UTF-8) 포인터 배열
+     * @param lengths 각 텍스트의 바이트 길이
+     * @param count 텍스트 수
+     * @param options 최대 길이, 자르기, 채우는 방향과 배수
+     * @param add_special_tokens 특수 토큰(시작, 종료) 추가 여부
+     * @return input_ids, attention_mask, token_type_ids 배열
+     */
+    PaddedBatch batch_encode_padded(const char* const* texts, const size_t* lengths, size_t count,
+                                    const PaddingOptions& options, bool add_special_tokens = true) const {
+        const size_t specials = add_special_tokens ? 2 : 0;
+        const bool truncate = options.truncation && options.maxLength > 0;
+        const bool fixedLength = truncate && options.padToMaxLength;
+
+        // 행 길이 결정 (가장 긴 문서에 맞추는 경우 먼저 인코딩)
+        EncodedBatch content;
+        size_t sequenceLength = options.maxLength;
+        if (!fixedLength) {
+            content = batch_encode(texts, lengths, count, false);
+            size_t longest = 0;
+            for (size_t i = 0; i < count; ++i) {
+                longest = std::max(longest, static_cast<size_t>(content.offsets[i + 1] - content.offsets[i]) + specials);
+            }
+            if (truncate) longest = std::min(longest, options.maxLength);
+            sequenceLength = options.padToMaxLength ? std::max(longest, options.maxLength) : longest;
+        }
+        if (options.padToMultipleOf > 1) {
+            sequenceLength = (sequenceLength + options.padToMultipleOf - 1) / options.padToMultipleOf * options.padToMultipleOf;
+        }
+        const size_t limit = truncate ? std::min(options.maxLength, sequenceLength) : sequenceLength; // 한 행의 최대 토큰 수
+        const int padId = (options.padId >= 0) ? options.padId : padTokenId();
 
-                if (matchedId != -1) {
-                    // 직접 메모리에서 토큰 생성 (복사 최소화)
-                    ids.push_back(matchedId);
-                    position += matchedLen;
-                    isSubword = true;
+        PaddedBatch batch;
+        batch.batchSize = count;
+        batch.sequenceLength = sequenceLength;
+        batch.inputIds.assign(count * sequenceLength, padId);
+        batch.attentionMask.assign(count * sequenceLength, 0);
+        batch.tokenTypeIds.assign(count * sequenceLength, 0);
+        if (sequenceLength == 0) return batch;
+
+        #pragma omp parallel for schedule(dynamic, 1)
+        for (int i = 0; i < static_cast<int>(count); ++i) {
+            int32_t* row = &batch.inputIds[static_cast<size_t>(i) * sequenceLength];
+            size_t length = 0;
+            if (add_special_tokens && limit < specials) {
+                // 시작/종료 토큰도 다 들어가지 않는 길이
+                if (limit) row[length++] = startId;
+            } else {
+                const size_t room = limit - specials;
+                if (add_special_tokens) row[length++] = startId;
+                if (fixedLength) {
+                    length += std::min(room, encode_into(texts[i], lengths[i], row + length, room, false));
                 } else {
-                    // UNK 토큰은 한 번만 복사
-                    ids.push_back(unkId);
-
-                    // UTF-8 문자 바이트 크기 계산
-                    unsigned char c = input_ptr[position];
-                    int byteCount = ((c & 0x80) == 0) ? 1 :
-                                    ((c & 0xE0) == 0xC0) ? 2 :
-                                    ((c & 0xF0) == 0xE0) ? 3 :
-                                    ((c & 0xF8) == 0xF0) ? 4 : 1;
-
-                    position += std::min(static_cast<size_t>(byteCount), remaining);
-                    isSubword = true;
+                    const size_t n = std::min(room, static_cast<size_t>(content.offsets[i + 1] - content.offsets[i]));
+                    if (n) std::memcpy(row + length, &content.ids[content.offsets[i]], n * sizeof(int32_t));
+                    length += n;
                 }
+                if (add_special_tokens) row[length++] = endId;
+            }
+
+            size_t start = 0;
+            if (options.padLeft && length < sequenceLength) {
+                start = sequenceLength - length;
+                std::memmove(row + start, row, length * sizeof(int32_t));
+                std::fill(row, row + start, padId);
             }
+            int32_t* mask = &batch.attentionMask[static_cast<size_t>(i) * sequenceLength];
+            std::fill(mask + start, mask + start + length, 1);
         }
-        
-        if (add_special_tokens) {
-            ids.push_back(endId);  // 종료 토큰 추가
+        return batch;
+    }
+
+    PaddedBatch batch_encode_padded(const std::vector<std::string>& texts, const PaddingOptions& options,
+                                    bool add_special_tokens = true) const {
+        std::vector<const char*> pointers(texts.size());
+        std::vector<size_t> lengths(texts.size());
+        for (size_t i = 0; i < texts.size(); ++i) {
+            pointers[i] = texts[i].data();
+            lengths[i] = texts[i].length();
         }
-        
-        return ids;
+        return batch_encode_padded(pointers.data(), lengths.data(), texts.size(), options, add_special_tokens);
     }
 
     /**
@@ -657,58 +2431,61 @@ public:
         
         // 필요한 경우 서브워드 접두사 길이 미리 계산
         const size_t prefixLength = subwordPrefix.length();
+        const bool isWordPiece = decoderType == "WordPiece";
+        const bool isMetaspace = decoderType == "Metaspace";
         
+        ensureDecodeTables();
         for (size_t i = 0; i < ids.size(); ++i) {
             int id = ids[i];
             
+            const char* token;
+            size_t tokenLength;
+            bool special;
+            if (!idTable.find(id, token, tokenLength, special)) {
+                continue;
+            }
+            
             // 특수 토큰 건너뛰기 (del_special_tokens가 true인 경우에만)
-            if (skip_special_tokens && isSpecialTokenId(id)) {
+            if (skip_special_tokens && special) {
                 continue;
             }
             
-            auto it = idToTokenMap.find(id);
-            if (it != idToTokenMap.end()) {
-                const std::string& token = it->second.token;
-                
-                // 디코더 타입에 따른 처리
-                if (decoderType == "WordPiece") {
-                    // ##으로 시작하는지 확인
-                    if (token.size() >= prefixLength && token.compare(0, prefixLength, subwordPrefix) == 0) {
-                        // 서브워드는 접두사 없이 추가
-                        result.append(token.c_str() + prefixLength, token.size() - prefixLength);
-                    } else {
-                        bool isSpecial = token.size() == 1 && isSpecialChar[static_cast<unsigned char>(token[0])];
-                        // 일반 토큰은 앞에 공백 추가 (첫 토큰 제외)
-                        if (!isSpecial && !result.empty()) {
-                            result.push_back(' ');
-                        }
-                        result.append(token);
+            // 디코더 타입에 따른 처리
+            if (isWordPiece) {
+                // ##으로 시작하는지 확인
+                if (tokenLength >= prefixLength && std::memcmp(token, subwordPrefix.data(), prefixLength) == 0) {
+                    // 서브워드는 접두사 없이 추가
+                    result.append(token + prefixLength, tokenLength - prefixLength);
+                } else {
+                    bool isSpecial = tokenLength == 1 && isSpecialChar[static_cast<unsigned char>(token[0])];
+                    // 일반 토큰은 앞에 공백 추가 (첫 토큰 제외)
+                    if (!isSpecial && !result.empty()) {
+                        result.push_back(' ');
                     }
-                } else if (decoderType == "Metaspace") {
-                    // ? 접두사로 시작하는지 확인
-                    bool isWordStart = token.size() >= prefixLength && 
-                                       token.compare(0, prefixLength, subwordPrefix) == 0;
+                    result.append(token, tokenLength);
+                }
+            } else if (isMetaspace) {
+                // ? 접두사로 시작하는지 확인
+                bool isWordStart = tokenLength >= prefixLength && 
+                                   std::memcmp(token, subwordPrefix.data(), prefixLength) == 0;
 
-                    //printf("#%s[%d] ", token.c_str(), token.size());
-                    
-                    if (isWordStart) {
-                        // 단어 시작 토큰이면 공백 추가 (첫 토큰 제외)
-                        if (!result.empty()) {
-                            result.push_back(' ');
-                        }
-                        // 접두사를 제외한 나머지 부분 추가
-                        result.append(token.c_str() + prefixLength, token.size() - prefixLength);
-                    } else {
-                        // 다른 토큰은 그대로 추가
-                        result.append(token);
-                    }
-                } else {
-                    // 기타 디코더 유형
+                if (isWordStart) {
+                    // 단어 시작 토큰이면 공백 추가 (첫 토큰 제외)
                     if (!result.empty()) {
                         result.push_back(' ');
                     }
-                    result.append(token);
+                    // 접두사를 제외한 나머지 부분 추가
+                    result.append(token + prefixLength, tokenLength - prefixLength);
+                } else {
+                    // 다른 토큰은 그대로 추가
+                    result.append(token, tokenLength);
+                }
+            } else {
+                // 기타 디코더 유형
+                if (!result.empty()) {
+                    result.push_back(' ');
                 }
+                result.append(token, tokenLength);
             }
         }
         
@@ -730,9 +2507,9 @@ std::vector<int> convert_tokens_to_ids(const std::vector<std::string>& tokens, b
     }
         
         for (const auto& token : tokens) {
-            auto it = tokenToIdMap.find(token);
-            if (it != tokenToIdMap.end()) {
-                ids.push_back(it->second);
+            int id;
+            if (findId(token, id)) {
+                ids.push_back(id);
             } else {
                 ids.push_back(unkId);
             }
@@ -755,15 +2532,17 @@ std::vector<std::string> convert_ids_to_tokens(const std::vector<int>& ids, bool
         std::vector<std::string> tokens;
         tokens.reserve(ids.size());
         
+        ensureDecodeTables();
         for (int id : ids) {
-        // 특수 토큰 건너뛰기 (del_special_tokens가 true인 경우에만)
-        if (skip_special_tokens && isSpecialTokenId(id)) {
-            continue;
-        }
-        
-            auto it = idToTokenMap.find(id);
-            if (it != idToTokenMap.end()) {
-            tokens.push_back(it->second.token);
+            const char* token;
+            size_t tokenLength;
+            bool special;
+            if (idTable.find(id, token, tokenLength, special)) {
+                // 특수 토큰 건너뛰기 (del_special_tokens가 true인 경우에만)
+                if (skip_special_tokens && special) {
+                    continue;
+                }
+                tokens.push_back(std::string(token, tokenLength));
             } else {
                 tokens.push_back(unkToken);
             }
@@ -838,7 +2617,6 @@ std::string convert_tokens_to_text(const std::vector<std::string>& tokens, bool
 
     /**
      * 텍스트를 공백 문자로 구분하여 단어 벡터로 반환합니다.
-     * XSIMD를 사용하여 성능을 최적화한 버전입니다.
      * 
      * @param text 분리할 텍스트
      * @return 공백으로 구분된 단어들의 벡터
@@ -848,9 +2626,25 @@ std::string convert_tokens_to_text(const std::vector<std::string>& tokens, bool
         if (text.empty()) return result;
     
         result.reserve(text.length() / 2); // 예상 단어 수 확보
-    
-        const char* data = text.data();
-        const size_t length = text.length();
+        forEachWord(text.data(), text.length(), [&result](const char* word, size_t length) {
+            result.emplace_back(word, length);
+        });
+        return result;
+    }
+
+    /**
+     * 텍스트의 단어 경계를 찾아 각 단어 구간을 onWord(포인터, 길이)로 전달합니다.
+     * XSIMD를 사용하여 성능을 최적화한 버전이며, 문자열을 새로 만들지 않습니다.
+     * 
+     * @param data 분리할 텍스트
+     * @param length 텍스트 길이
+     * @param onWord 단어마다 호출되는 함수 (const char*, size_t)
+     */
+    template <class F>
+    void forEachWord(const char* data, const size_t length, F&& onWord) const {
+        if (length == 0) return;
+
+        const bool isWordPiece = (decoderType == "WordPiece");
         size_t word_start = 0;
         size_t i = 0;
     
@@ -862,7 +2656,7 @@ std::string convert_tokens_to_text(const std::vector<std::string>& tokens, bool
         while (i + simd_size <= length) {
             uint64_t mask = 0;
             
-            if( decoderType == "WordPiece" ) {
+            if( isWordPiece ) {
                 // SIMD 배치의 각 문자에 대해 isSpecialChar 테이블 참조
                 for (size_t j = 0; j < simd_size; ++j) {
                     if (isSpecialChar[static_cast<unsigned char>(data[i + j])]) {
@@ -885,14 +2679,14 @@ std::string convert_tokens_to_text(const std::vector<std::string>& tokens, bool
                 int offset = CountTrailingZeros64(mask);
                 size_t pos = i + offset;
                 
-                // 이전 위치부터 현재 특수 문자 위치까지 단어로 추가
+                // 이전 위치부터 현재 특수 문자 위치까지 단어로 전달
                 if (pos > word_start) {
-                    result.emplace_back(&data[word_start], pos - word_start);
+                    onWord(&data[word_start], pos - word_start);
                 }
                 
-                // 공백이 아닌 특수 문자는 개별 토큰으로 추가
-                if (decoderType == "WordPiece" && !isWhitespaceChar[static_cast<unsigned char>(data[pos])]) {
-                    result.emplace_back(&data[pos], 1);
+                // 공백이 아닌 특수 문자는 개별 토큰으로 전달
+                if (isWordPiece && !isWhitespaceChar[static_cast<unsigned char>(data[pos])]) {
+                    onWord(&data[pos], 1);
                 }
                 
                 word_start = pos + 1;
@@ -906,16 +2700,16 @@ std::string convert_tokens_to_text(const std::vector<std::string>& tokens, bool
         
         // 나머지 부분 처리 (SIMD로 처리할 수 없는 부분)
         for (; i < length; ++i) {
-            if( decoderType == "WordPiece") {
+            if( isWordPiece ) {
                 if (isSpecialChar[static_cast<unsigned char>(data[i])]) {
-                    // 현재 위치 이전에 수집된 단어가 있으면 추가
+                    // 현재 위치 이전에 수집된 단어가 있으면 전달
                     if (i > word_start) {
-                        result.emplace_back(&data[word_start], i - word_start);
+                        onWord(&data[word_start], i - word_start);
                     }
                     
-                    // 공백이 아닌 특수 문자는 개별 토큰으로 추가
+                    // 공백이 아닌 특수 문자는 개별 토큰으로 전달
                     if ( !isWhitespaceChar[static_cast<unsigned char>(data[i])]) {
-                        result.emplace_back(&data[i], 1);
+                        onWord(&data[i], 1);
                     }
                     
                     word_start = i + 1;
@@ -923,7 +2717,7 @@ std::string convert_tokens_to_text(const std::vector<std::string>& tokens, bool
             } else {
                 if (std::isspace(static_cast<unsigned char>(data[i]))) {
                     if (i > word_start) {
-                        result.emplace_back(&data[word_start], i - word_start);
+                        onWord(&data[word_start], i - word_start);
                     }
                     word_start = i + 1;
                 }
@@ -932,10 +2726,8 @@ std::string convert_tokens_to_text(const std::vector<std::string>& tokens, bool
         
         // 마지막 단어 처리
         if (word_start < length) {
-            result.emplace_back(&data[word_start], length - word_start);
+            onWord(&data[word_start], length - word_start);
         }
-        
-        return result;
     }
 
 };
@@ -0,0 +1,20 @@
+#pragma once
+#ifndef PREFETCH_H
+#define PREFETCH_H
+
+// 플랫폼 독립적인 읽기용 프리페치 (캐시 라인을 미리 가져오기만 하고 결과에는 영향 없음)
+#if defined(_MSC_VER)
+#include <xmmintrin.h>
+
+inline void PrefetchRead(const void* p) {
+    _mm_prefetch(static_cast<const char*>(p), _MM_HINT_T0);
+}
+
+#else
+// GCC, Clang 등에서는 내장 함수 사용
+inline void PrefetchRead(const void* p) {
+    __builtin_prefetch(p, 0, 3);
+}
+#endif
+
+#endif
@@ -0,0 +1,281 @@
+#pragma once
+#ifndef RADIX_TRIE_H
+#define RADIX_TRIE_H
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include <xsimd/xsimd.hpp>
+#include "prefetch.h"
+#include "compiled_image.h"
+
+/****************************************************************
+* Class Name: RadixTrie
+* Description: 압축방식 Trie (Radix / Patricia Trie)
+*              자식이 하나뿐인 비종료 노드 체인을 하나의 바이트 문자열
+*              간선 레이블로 합침 (한글/CJK 3바이트 문자 체인 등)
+*              간선 레이블은 XSIMD로 한 번에 비교하여 바이트 단위
+*              포인터 추적을 줄임
+*              바이트 단위 상태: 하위 24비트 = 노드 번호,
+*              상위 8비트 = 간선 안에서 소비한 바이트 수 (0이면 노드 위)
+****************************************************************/
+class RadixTrie {
+public:
+    enum : uint32_t { NONE = 0xFFFFFFFFu };
+    enum : uint32_t { NODE_MASK = 0x00FFFFFFu, OFFSET_SHIFT = 24 };
+    enum : size_t { MAX_LABEL = 255, MAX_NODES = NODE_MASK };
+
+    struct Node {
+        uint32_t labelOffset; // 이 노드로 들어오는 간선 레이블의 blob 내 시작 위치
+        uint32_t firstChild;  // 첫 번째 자식의 인덱스
+        int32_t id;           // 토큰 ID (종료 노드가 아니면 -1)
+        uint16_t childCount;  // 자식 수
+        uint8_t labelLength;  // 간선 레이블 길이 (1~255, 루트는 0)
+        uint8_t flags;        // bit0: 특수 토큰 여부
+    };
+
+    enum : uint8_t { FLAG_SPECIAL = 1 };
+
+    RadixTrie(): nodeData(nullptr), firstByteData(nullptr), blobData(nullptr), nodeSize(0), blobSize(0) {
+        std::memset(rootChildren, 0xFF, sizeof(rootChildren));
+    }
+
+    // 검색용 포인터가 자기 벡터를 가리키므로 복사는 금지하고 이동만 허용
+    RadixTrie(const RadixTrie&) = delete;
+    RadixTrie& operator=(const RadixTrie&) = delete;
+    RadixTrie(RadixTrie&&) = default;
+    RadixTrie& operator=(RadixTrie&&) = default;
+
+    void clear() {
+        nodes.clear();
+        nodes.shrink_to_fit();
+        firstBytes.clear();
+        firstBytes.shrink_to_fit();
+        blob.clear();
+        blob.shrink_to_fit();
+        nodeData = nullptr;
+        firstByteData = nullptr;
+        blobData = nullptr;
+        nodeSize = 0;
+        blobSize = 0;
+        std::memset(rootChildren, 0xFF, sizeof(rootChildren));
+    }
+
+    bool empty() const { return nodeSize == 0; }
+
+    uint32_t root() const { return 0; }
+
+    // 한 바이트 전이 (성공 시 state 갱신). 간선 중간이면 레이블의 다음 바이트와 비교
+    inline bool next(uint32_t& state, unsigned char ch) const {
+        const uint32_t index = state & NODE_MASK;
+        uint32_t consumed = state >> OFFSET_SHIFT;
+
+        if (consumed) {
+            const Node& node = nodeData[index];
+            if (blobData[node.labelOffset + consumed] != ch) return false;
+            ++consumed;
+            state = (consumed == node.labelLength) ? index : ((consumed << OFFSET_SHIFT) | index);
+            return true;
+        }
+
+        const uint32_t child = findChild(index, ch);
+        if (child == NONE) return false;
+        state = (nodeData[child].labelLength == 1) ? child : ((1u << OFFSET_SHIFT) | child);
+        return true;
+    }
+
+    // state 노드의 자식 첫 바이트 구간을 미리 가져옴 (간선 중간이면 레이블)
+    inline void prefetch(uint32_t state, unsigned char /*ch*/) const {
+        const Node& node = nodeData[state & NODE_MASK];
+        if (state >> OFFSET_SHIFT) PrefetchRead(blobData + node.labelOffset + (state >> OFFSET_SHIFT));
+        else PrefetchRead(firstByteData + node.firstChild);
+    }
+
+    inline int value(uint32_t state) const {
+        return (state >> OFFSET_SHIFT) ? -1 : nodeData[state].id;
+    }
+
+    inline bool isSpecial(uint32_t state) const {
+        return !(state >> OFFSET_SHIFT) && (nodeData[state].flags & FLAG_SPECIAL) != 0;
+    }
+
+    /**
+     * state에서 시작해 입력의 최장 일치 토큰을 찾습니다.
+     * 노드 사이는 간선 레이블 전체를 한 번에 비교합니다.
+     * @param matchedId 찾은 토큰 ID (없으면 변경하지 않음)
+     * @param matchedLen 찾은 토큰이 소비한 입력 바이트 수
+     */
+    inline void longestMatch(uint32_t state, const char* input, size_t length, int& matchedId, int& matchedLen) const {
+        const unsigned char* in = reinterpret_cast<const unsigned char*>(input);
+        uint32_t index = state & NODE_MASK;
+        size_t i = 0;
+
+        // 간선 중간에서 시작하면 남은 레이블부터 비교
+        const uint32_t consumed = state >> OFFSET_SHIFT;
+        if (consumed) {
+            const Node& node = nodeData[index];
+            const size_t rest = node.labelLength - consumed;
+            if (rest > length || commonPrefix(blobData + node.labelOffset + consumed, in, rest) < rest) return;
+            i = rest;
+            if (node.id != -1) {
+                matchedId = node.id;
+                matchedLen = static_cast<int>(i);
+            }
+        }
+
+        while (i < length) {
+            const uint32_t child = findChild(index, in[i]);
+            if (child == NONE) break;
+
+            const Node& node = nodeData[child];
+            const size_t labelLength = node.labelLength;
+            if (labelLength > 1) {
+                if (labelLength > length - i) break;
+                if (commonPrefix(blobData + node.labelOffset + 1, in + i + 1, labelLength - 1) < labelLength - 1) break;
+            }
+
+            i += labelLength;
+            index = child;
+            if (node.id != -1) {
+                matchedId = node.id;
+                matchedLen = static_cast<int>(i);
+            }
+        }
+    }
+
+    size_t size() const { return nodeSize; }
+
+    size_t memoryUsage() const {
+        return std::max(nodes.capacity(), nodeSize) * (sizeof(Node) + 1) + std::max(blob.capacity(), blobSize) + sizeof(rootChildren);
+    }
+
+    // 컴파일된 이미지에 노드 배열, 첫 바이트 배열, 레이블 blob을 기록합니다.
+    void save(CompiledWriter& writer) const {
+        writer.add(CompiledTag('R', 'X', 'N', 'D'), nodeData, nodeSize);
+        writer.add(CompiledTag('R', 'X', 'F', 'B'), firstByteData, nodeSize);
+        writer.add(CompiledTag('R', 'X', 'B', 'L'), blobData, blobSize);
+        writer.add(CompiledTag('R', 'X', 'R', 'C'), rootChildren, 256);
+    }
+
+    /**
+     * 컴파일된 이미지의 배열을 복사 없이 사용합니다. (루트 직접 테이블만 복사)
+     * @return 필요한 섹션이 모두 있고 올바르면 true
+     */
+    bool attach(const CompiledReader& reader) {
+        const Node* nodeArray;
+        const uint8_t* firstArray;
+        const uint8_t* blobArray;
+        const uint32_t* rootArray;
+        size_t count, firstCount, blobCount, rootCount;
+        if (!reader.get(CompiledTag('R', 'X', 'N', 'D'), nodeArray, count) || count == 0) return false;
+        if (!reader.get(CompiledTag('R', 'X', 'F', 'B'), firstArray, firstCount) || firstCount != count) return false;
+        if (!reader.get(CompiledTag('R', 'X', 'B', 'L'), blobArray, blobCount)) return false;
+        if (!reader.get(CompiledTag('R', 'X', 'R', 'C'), rootArray, rootCount) || rootCount != 256) return false;
+        clear();
+        nodeData = nodeArray;
+        firstByteData = firstArray;
+        blobData = blobArray;
+        nodeSize = count;
+        blobSize = blobCount;
+        std::memcpy(rootChildren, rootArray, sizeof(rootChildren));
+        return true;
+    }
+
+    /**
+     * 빌드를 시작합니다. 노드는 BFS 순서로 추가해야 합니다.
+     * @param nodeCount 예상 노드 수 (루트 포함)
+     */
+    void beginBuild(size_t nodeCount) {
+        clear();
+        nodes.reserve(nodeCount);
+        firstBytes.reserve(nodeCount);
+        blob.reserve(nodeCount * 2);
+    }
+
+    /**
+     * BFS 순서로 다음 노드를 추가합니다.
+     * @param label 부모에서 이 노드로 오는 간선 레이블 (루트는 길이 0)
+     * @return 추가된 노드의 인덱스
+     */
+    uint32_t appendNode(const unsigned char* label, size_t labelLength, int id, bool special) {
+        Node node = { static_cast<uint32_t>(blob.size()), 0, id, 0,
+                      static_cast<uint8_t>(labelLength), static_cast<uint8_t>(special ? FLAG_SPECIAL : 0) };
+        nodes.push_back(node);
+        firstBytes.push_back(labelLength ? label[0] : 0);
+        blob.insert(blob.end(), label, label + labelLength);
+        return static_cast<uint32_t>(nodes.size() - 1);
+    }
+
+    // 노드의 자식 구간을 설정합니다. (자식들은 이미 연속으로 추가되어 있어야 함)
+    void setChildren(uint32_t index, uint32_t firstChild, uint32_t childCount) {
+        nodes[index].firstChild = firstChild;
+        nodes[index].childCount = static_cast<uint16_t>(childCount);
+        if (index == 0) {
+            for (uint32_t i = 0; i < childCount; ++i) {
+                rootChildren[firstBytes[firstChild + i]] = firstChild + i;
+            }
+        }
+    }
+
+    void finishBuild() {
+        nodes.shrink_to_fit();
+        firstBytes.shrink_to_fit();
+        blob.shrink_to_fit();
+        nodeData = nodes.data();
+        firstByteData = firstBytes.data();
+        blobData = blob.data();
+        nodeSize = nodes.size();
+        blobSize = blob.size();
+    }
+
+private:
+    std::vector<Node> nodes;          // BFS 순서의 노드 배열 (컴파일된 이미지를 쓰면 비어 있음)
+    std::vector<uint8_t> firstBytes;  // firstBytes[i]: 노드 i 간선 레이블의 첫 바이트 (형제끼리 연속)
+    std::vector<uint8_t> blob;        // 모든 간선 레이블을 이어붙인 바이트 배열
+    const Node* nodeData;             // 검색에 쓰는 배열 (위 벡터 또는 매핑된 이미지)
+    const uint8_t* firstByteData;
+    const uint8_t* blobData;
+    size_t nodeSize;
+    size_t blobSize;
+    uint32_t rootChildren[256];       // 루트 자식 직접 테이블
+
+    inline uint32_t findChild(uint32_t index, unsigned char ch) const {
+        if (index == 0) return rootChildren[ch];
+
+        const Node& node = nodeData[index];
+        const uint8_t* begin = firstByteData + node.firstChild;
+        const uint32_t count = node.childCount;
+        for (uint32_t i = 0; i < count; ++i) {
+            if (begin[i] == ch) return node.firstChild + i;
+            if (begin[i] > ch) break;
+        }
+        return NONE;
+    }
+
+    // 두 바이트열의 공통 접두사 길이 (최대 length)
+    // 긴 레이블은 XSIMD 배치, 짧은 레이블은 8바이트 단위로 비교하고 불일치 구간만 바이트 단위로 확인
+    static inline size_t commonPrefix(const unsigned char* a, const unsigned char* b, size_t length) {
+        using batch_type = xsimd::batch<int8_t>;
+        constexpr size_t simd_size = batch_type::size;
+
+        size_t i = 0;
+        while (i + simd_size <= length) {
+            batch_type va = xsimd::load_unaligned(reinterpret_cast<const int8_t*>(a + i));
+            batch_type vb = xsimd::load_unaligned(reinterpret_cast<const int8_t*>(b + i));
+            if (!xsimd::all(va == vb)) break;
+            i += simd_size;
+        }
+        while (i + 8 <= length) {
+            uint64_t wa, wb;
+            std::memcpy(&wa, a + i, 8);
+            std::memcpy(&wb, b + i, 8);
+            if (wa != wb) break;
+            i += 8;
+        }
+        while (i < length && a[i] == b[i]) ++i;
+        return i;
+    }
+};
+
+#endif
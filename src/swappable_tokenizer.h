@@ -0,0 +1,159 @@
+#pragma once
+#ifndef SWAPPABLE_TOKENIZER_H
+#define SWAPPABLE_TOKENIZER_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "nemo_tokenizer.h"
+
+/****************************************************************
+* Class Name: SwappableTokenizer
+* Description: 사용 중에 모델을 교체할 수 있는 NemoTokenizer 래퍼 (RCU 방식)
+*              새 모델은 별도 인스턴스에 로드한 뒤 잠금 안에서 교체하고 버전을 올림
+*              각 스레드는 모델의 shared_ptr을 스레드 지역 캐시에 들고 있다가
+*              버전이 바뀐 것을 본 첫 호출에서만 잠금을 잡고 새 모델로 갱신함
+*              호출 경로는 버전 원자 읽기 한 번과 캐시 비교뿐이며 잠금도,
+*              공유 참조 카운트 증감도 없음 (std::atomic_load(shared_ptr)는
+*              libstdc++/MSVC에서 전역 잠금 풀을 사용하므로 쓰지 않음)
+*              이전 모델은 그것을 캐시한 모든 스레드가 다음 호출에서 갱신하거나
+*              종료하면 해제됨 (유휴 스레드는 그때까지 이전 모델을 붙잡음)
+****************************************************************/
+class SwappableTokenizer {
+public:
+    SwappableTokenizer(): trieEngine(TrieEngine::DoubleArray), interleaved(false), decodeTables(true),
+                          instanceId(nextInstanceId()), version(1), current(std::make_shared<NemoTokenizer>()) {}
+
+    SwappableTokenizer(const SwappableTokenizer&) = delete;
+    SwappableTokenizer& operator=(const SwappableTokenizer&) = delete;
+
+    // 다음 로드부터 적용할 설정 (NemoTokenizer의 같은 이름 함수와 동일)
+    void setTrieEngine(TrieEngine engine) { trieEngine = engine; }
+    void setInterleavedMatching(bool enable) { interleaved = enable; }
+    void setDecodeTables(bool enable) { decodeTables = enable; }
+
+    // 현재 모델의 스냅샷 (반환된 포인터를 들고 있는 동안 교체되어도 해제되지 않음)
+    std::shared_ptr<const NemoTokenizer> snapshot() const {
+        return cachedModel();
+    }
+
+    // 완성된 모델로 교체합니다. 각 스레드는 다음 호출부터 새 모델을 사용합니다.
+    void publish(std::shared_ptr<const NemoTokenizer> next) {
+        std::lock_guard<std::mutex> lock(publishMutex);
+        current = std::move(next);
+        version.store(version.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /**
+     * tokenizer.json 파일로 새 모델을 만들어 교체합니다.
+     * @return 성공 여부 (파일이 없거나 올바르지 않으면 종료하지 않고 현재 모델을 그대로 사용)
+     */
+    bool loadTokenizer(const std::string& filename) {
+        std::shared_ptr<NemoTokenizer> next = create();
+        if (!next->tryLoadTokenizer(filename)) return false;
+        publish(std::move(next));
+        return true;
+    }
+
+    /**
+     * 메모리의 tokenizer.json 내용으로 새 모델을 만들어 교체합니다.
+     * @return 성공 여부 (실패하면 현재 모델을 그대로 사용)
+     */
+    bool loadFromBuffer(const char* data, size_t size) {
+        std::shared_ptr<NemoTokenizer> next = create();
+        if (!next->loadFromBuffer(data, size)) return false;
+        publish(std::move(next));
+        return true;
+    }
+
+    bool loadCompiled(const std::string& filename) {
+        std::shared_ptr<NemoTokenizer> next = create();
+        if (!next->loadCompiled(filename)) return false;
+        publish(std::move(next));
+        return true;
+    }
+
+    bool loadEmbedded(const unsigned char* data, size_t size) {
+        std::shared_ptr<NemoTokenizer> next = create();
+        if (!next->loadEmbedded(data, size)) return false;
+        publish(std::move(next));
+        return true;
+    }
+
+    std::vector<std::string> tokenize(const std::string& text, bool add_special_tokens = true) const {
+        return cachedModel()->tokenize(text, add_special_tokens);
+    }
+
+    std::vector<int> encode(const std::string& text, bool add_special_tokens = true) const {
+        return cachedModel()->encode(text, add_special_tokens);
+    }
+
+    std::string decode(const std::vector<int>& ids, bool skip_special_tokens = true) const {
+        return cachedModel()->decode(ids, skip_special_tokens);
+    }
+
+private:
+    TrieEngine trieEngine;
+    bool interleaved;
+    bool decodeTables;
+    const uint64_t instanceId;           // 스레드 지역 캐시에서 인스턴스를 구분 (주소는 재사용될 수 있어 번호 사용)
+    std::atomic<uint64_t> version;       // publish마다 증가
+    mutable std::mutex publishMutex;     // current와 version을 함께 바꾸고 읽을 때만 사용
+    std::shared_ptr<const NemoTokenizer> current;
+
+    // 스레드 지역 모델 캐시 (여러 인스턴스를 번갈아 쓰는 스레드를 위해 몇 칸 유지)
+    struct CacheSlot {
+        uint64_t owner = 0;
+        uint64_t version = 0;
+        std::shared_ptr<const NemoTokenizer> model;
+    };
+    enum { CACHE_SLOTS = 4 };
+
+    static uint64_t nextInstanceId() {
+        static std::atomic<uint64_t> counter(0);
+        return ++counter;
+    }
+
+    /**
+     * 이 스레드가 캐시한 현재 모델을 반환합니다.
+     * 버전이 같으면 잠금 없이 캐시를 그대로 쓰고, 바뀌었을 때만 잠금 안에서 갱신합니다.
+     * 반환된 참조는 같은 스레드가 다음에 이 함수를 부를 때까지 유효합니다.
+     */
+    const std::shared_ptr<const NemoTokenizer>& cachedModel() const {
+        static thread_local CacheSlot slots[CACHE_SLOTS];
+        static thread_local unsigned nextSlot = 0;
+
+        CacheSlot* slot = nullptr;
+        for (CacheSlot& candidate : slots) {
+            if (candidate.owner == instanceId) {
+                slot = &candidate;
+                break;
+            }
+        }
+        if (!slot) {
+            slot = &slots[nextSlot++ % CACHE_SLOTS];
+            slot->owner = instanceId;
+            slot->version = 0;
+        }
+
+        if (slot->version != version.load(std::memory_order_acquire)) {
+            std::lock_guard<std::mutex> lock(publishMutex);
+            slot->model = current;
+            slot->version = version.load(std::memory_order_relaxed);
+        }
+        return slot->model;
+    }
+
+    std::shared_ptr<NemoTokenizer> create() const {
+        std::shared_ptr<NemoTokenizer> next = std::make_shared<NemoTokenizer>();
+        next->setTrieEngine(trieEngine);
+        next->setInterleavedMatching(interleaved);
+        next->setDecodeTables(decodeTables);
+        return next;
+    }
+};
+
+#endif
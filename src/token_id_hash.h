@@ -0,0 +1,327 @@
+#pragma once
+#ifndef TOKEN_ID_HASH_H
+#define TOKEN_ID_HASH_H
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include "compiled_image.h"
+
+/****************************************************************
+* Class Name: TokenIdHash
+* Description: 토큰 -> ID 최소 완전 해시 (PTHash/CHD 방식 hash-and-displace)
+*              키 n개를 버킷 n/3개로 나누고, 큰 버킷부터 모든 키가 빈 위치에
+*              들어가는 pilot 값을 찾아 버킷별로 저장
+*              위치는 n보다 약간 큰 범위(부하율 약 0.95)에서 찾고, n 이상인 위치는
+*              n 미만의 빈 슬롯으로 다시 연결하여 슬롯 배열은 키 수와 같게 유지
+*              조회: 해시 1번 -> pilot 1개 -> 슬롯 1개 -> 문자열 비교 1번
+*              슬롯의 지문(fingerprint)이 다르면 문자열을 읽지 않고 바로 실패
+*              문자열은 호출한 쪽의 어휘 blob을 가리킴 (ID 테이블과 공유)
+****************************************************************/
+class TokenIdHash {
+public:
+    enum : uint32_t { FLAG_ID = 1, FLAG_SPECIAL = 2, FLAG_MASK = 0xFFu, FINGERPRINT_MASK = 0xFFFFFF00u };
+
+    // 빌드 입력 키 하나 (문자열은 blob[offset, offset + length))
+    struct Key {
+        uint32_t offset;
+        uint32_t length;
+        int32_t id;     // FLAG_ID가 없으면 의미 없음
+        uint32_t flags; // FLAG_ID: 토큰 -> ID 변환 대상, FLAG_SPECIAL: 특수 토큰
+    };
+
+    struct Slot {
+        uint32_t offset;
+        uint32_t length;
+        int32_t id;
+        uint32_t tag;   // 상위 24비트: 해시 지문, 하위 8비트: flags
+    };
+
+    // 'VCHP' 섹션
+    struct Params {
+        uint64_t seed;
+        uint64_t bucketCount;
+        uint64_t slotCount;  // 키 수
+        uint64_t tableSize;  // pilot으로 찾는 위치 범위 (slotCount 이상, 넘는 부분은 remap으로 연결)
+    };
+
+    TokenIdHash(): pilotData(nullptr), slotData(nullptr), remapData(nullptr), blobData(nullptr), blobSize(0) {
+        std::memset(&params, 0, sizeof(params));
+    }
+
+    // 검색용 포인터가 자기 벡터를 가리키므로 복사는 금지하고 이동만 허용
+    TokenIdHash(const TokenIdHash&) = delete;
+    TokenIdHash& operator=(const TokenIdHash&) = delete;
+    TokenIdHash(TokenIdHash&&) = default;
+    TokenIdHash& operator=(TokenIdHash&&) = default;
+
+    void clear() {
+        pilots.clear();
+        pilots.shrink_to_fit();
+        slots.clear();
+        slots.shrink_to_fit();
+        remap.clear();
+        remap.shrink_to_fit();
+        pilotData = nullptr;
+        slotData = nullptr;
+        remapData = nullptr;
+        blobData = nullptr;
+        blobSize = 0;
+        std::memset(&params, 0, sizeof(params));
+    }
+
+    static inline uint64_t mix(uint64_t x) {
+        x ^= x >> 33;
+        x *= 0xFF51AFD7ED558CCDULL;
+        x ^= x >> 33;
+        x *= 0xC4CEB9FE1A85EC53ULL;
+        x ^= x >> 33;
+        return x;
+    }
+
+    // 8바이트 단위 문자열 해시 (빌드할 때 같은 토큰을 묶는 데도 사용)
+    static inline uint64_t hashBytes(const char* data, size_t length, uint64_t seed) {
+        uint64_t h = seed ^ (length * 0x9E3779B97F4A7C15ULL);
+        size_t i = 0;
+        for (; i + 8 <= length; i += 8) {
+            uint64_t w;
+            std::memcpy(&w, data + i, 8);
+            h = (h ^ w) * 0x9FB21C651E98DF25ULL;
+            h ^= h >> 29;
+        }
+        if (i < length) {
+            uint64_t w = 0;
+            std::memcpy(&w, data + i, length - i);
+            h = (h ^ w) * 0x9FB21C651E98DF25ULL;
+        }
+        return mix(h);
+    }
+
+    size_t size() const { return static_cast<size_t>(params.slotCount); }
+
+    const char* blobBegin() const { return blobData; }
+    size_t blobLength() const { return blobSize; }
+
+    // 토큰의 슬롯 (없으면 nullptr)
+    inline const Slot* find(const char* token, size_t length) const {
+        if (params.slotCount == 0) return nullptr;
+        const uint64_t h = hashBytes(token, length, params.seed);
+        const Slot& slot = slotData[slotIndex(positionOf(h, pilotData[bucketOf(h)]))];
+        if ((slot.tag ^ static_cast<uint32_t>(h)) & FINGERPRINT_MASK) return nullptr;
+        if (slot.length != length || std::memcmp(blobData + slot.offset, token, length) != 0) return nullptr;
+        return &slot;
+    }
+
+    inline bool findId(const char* token, size_t length, int& id) const {
+        const Slot* slot = find(token, length);
+        if (!slot || !(slot->tag & FLAG_ID)) return false;
+        id = slot->id;
+        return true;
+    }
+
+    inline bool isSpecial(const char* token, size_t length) const {
+        const Slot* slot = find(token, length);
+        return slot && (slot->tag & FLAG_SPECIAL);
+    }
+
+    size_t memoryUsage() const {
+        return std::max(pilots.capacity(), static_cast<size_t>(params.bucketCount)) * sizeof(uint32_t)
+             + std::max(slots.capacity(), static_cast<size_t>(params.slotCount)) * sizeof(Slot)
+             + std::max(remap.capacity(), static_cast<size_t>(params.tableSize - params.slotCount)) * sizeof(uint32_t);
+    }
+
+    // 컴파일된 이미지에 매개변수, pilot 배열, 슬롯 배열, remap 배열을 기록합니다. (blob은 호출한 쪽에서 기록)
+    void save(CompiledWriter& writer) const {
+        writer.addValue(CompiledTag('V', 'C', 'H', 'P'), params);
+        writer.add(CompiledTag('V', 'C', 'P', 'L'), pilotData, static_cast<size_t>(params.bucketCount));
+        writer.add(CompiledTag('V', 'C', 'S', 'L'), slotData, static_cast<size_t>(params.slotCount));
+        writer.add(CompiledTag('V', 'C', 'R', 'M'), remapData, static_cast<size_t>(params.tableSize - params.slotCount));
+    }
+
+    /**
+     * 컴파일된 이미지의 배열을 복사 없이 사용합니다.
+     * @param blobBase 슬롯이 가리키는 토큰 문자열 blob
+     * @param blobLimit blob 바이트 수
+     * @return 섹션이 모두 있고 슬롯이 blob 범위 안을 가리키면 true
+     */
+    bool attach(const CompiledReader& reader, const char* blobBase, size_t blobLimit) {
+        Params p;
+        const uint32_t* pilotArray;
+        const Slot* slotArray;
+        const uint32_t* remapArray;
+        size_t pilotCount, slotCount, remapCount;
+        if (!reader.getValue(CompiledTag('V', 'C', 'H', 'P'), p) || p.tableSize < p.slotCount || p.tableSize > 0xFFFFFFFFu) return false;
+        if (!reader.get(CompiledTag('V', 'C', 'P', 'L'), pilotArray, pilotCount) || pilotCount != p.bucketCount) return false;
+        if (!reader.get(CompiledTag('V', 'C', 'S', 'L'), slotArray, slotCount) || slotCount != p.slotCount) return false;
+        if (!reader.get(CompiledTag('V', 'C', 'R', 'M'), remapArray, remapCount) || remapCount != p.tableSize - p.slotCount) return false;
+        if (slotCount && !pilotCount) return false;
+        for (size_t i = 0; i < slotCount; ++i) {
+            if (slotArray[i].offset > blobLimit || slotArray[i].length > blobLimit - slotArray[i].offset) return false;
+        }
+        for (size_t i = 0; i < remapCount; ++i) {
+            if (remapArray[i] >= slotCount) return false;
+        }
+        clear();
+        params = p;
+        pilotData = pilotArray;
+        slotData = slotArray;
+        remapData = remapArray;
+        blobData = blobBase;
+        blobSize = blobLimit;
+        return true;
+    }
+
+    /**
+     * 키 목록으로 최소 완전 해시를 만듭니다. 키 문자열은 서로 달라야 합니다.
+     * 같은 64비트 해시를 가진 키가 있거나 pilot을 찾지 못하면 시드를 바꿔 다시 시도합니다.
+     * @param keys 키 배열
+     * @param count 키 수
+     * @param blobBase 키 문자열이 있는 blob (해시가 살아 있는 동안 유지되어야 함)
+     * @param blobLimit blob 바이트 수
+     * @return 성공 여부
+     */
+    bool build(const Key* keys, size_t count, const char* blobBase, size_t blobLimit) {
+        clear();
+        blobData = blobBase;
+        blobSize = blobLimit;
+        if (count == 0) return true;
+
+        const uint64_t bucketCount = std::max<uint64_t>(1, (count + KEYS_PER_BUCKET - 1) / KEYS_PER_BUCKET);
+        const uint64_t tableSize = count + count * TABLE_SLACK_PERCENT / 100;
+        std::vector<uint64_t> hashes(count);
+        std::vector<uint32_t> bucketStart(bucketCount + 1);
+        std::vector<uint32_t> bucketKeys(count);
+        std::vector<uint32_t> order(bucketCount);
+        std::vector<uint64_t> taken((tableSize + 63) / 64);
+        std::vector<uint32_t> positions;
+
+        for (uint64_t attempt = 0; attempt < MAX_ATTEMPTS; ++attempt) {
+            params.seed = SEED_BASE + attempt * 0x9E3779B97F4A7C15ULL;
+            params.bucketCount = bucketCount;
+            params.slotCount = count;
+            params.tableSize = tableSize;
+
+            // 버킷별로 키 모으기 (계수 정렬)
+            std::fill(bucketStart.begin(), bucketStart.end(), 0);
+            for (size_t i = 0; i < count; ++i) {
+                hashes[i] = hashBytes(blobBase + keys[i].offset, keys[i].length, params.seed);
+                ++bucketStart[bucketOf(hashes[i]) + 1];
+            }
+            for (uint64_t b = 0; b < bucketCount; ++b) bucketStart[b + 1] += bucketStart[b];
+            {
+                std::vector<uint32_t> fill(bucketStart.begin(), bucketStart.end() - 1);
+                for (size_t i = 0; i < count; ++i) bucketKeys[fill[bucketOf(hashes[i])]++] = static_cast<uint32_t>(i);
+            }
+
+            // 큰 버킷부터 배치 (크기별 계수 정렬)
+            {
+                uint32_t maxSize = 0;
+                for (uint64_t b = 0; b < bucketCount; ++b) maxSize = std::max(maxSize, bucketStart[b + 1] - bucketStart[b]);
+                std::vector<uint32_t> sizeStart(maxSize + 2, 0);
+                for (uint64_t b = 0; b < bucketCount; ++b) ++sizeStart[maxSize - (bucketStart[b + 1] - bucketStart[b]) + 1];
+                for (uint32_t k = 0; k <= maxSize; ++k) sizeStart[k + 1] += sizeStart[k];
+                for (uint64_t b = 0; b < bucketCount; ++b) {
+                    order[sizeStart[maxSize - (bucketStart[b + 1] - bucketStart[b])]++] = static_cast<uint32_t>(b);
+                }
+            }
+
+            pilots.assign(bucketCount, 0);
+            std::fill(taken.begin(), taken.end(), 0);
+            pilotData = pilots.data();
+            if (placeBuckets(hashes, bucketStart, bucketKeys, order, taken, positions)) {
+                // 범위를 넘은 위치를 n 미만의 빈 슬롯에 차례로 연결 (두 수는 항상 같음)
+                remap.assign(tableSize - count, 0);
+                uint64_t hole = 0;
+                for (uint64_t pos = count; pos < tableSize; ++pos) {
+                    if (!((taken[pos >> 6] >> (pos & 63)) & 1)) continue;
+                    while ((taken[hole >> 6] >> (hole & 63)) & 1) ++hole;
+                    remap[pos - count] = static_cast<uint32_t>(hole++);
+                }
+                remapData = remap.data();
+
+                slots.resize(count);
+                for (size_t i = 0; i < count; ++i) {
+                    const uint64_t h = hashes[i];
+                    Slot& slot = slots[slotIndex(positionOf(h, pilots[bucketOf(h)]))];
+                    slot.offset = keys[i].offset;
+                    slot.length = keys[i].length;
+                    slot.id = keys[i].id;
+                    slot.tag = (static_cast<uint32_t>(h) & FINGERPRINT_MASK) | (keys[i].flags & FLAG_MASK);
+                }
+                slotData = slots.data();
+                return true;
+            }
+        }
+        clear();
+        return false;
+    }
+
+private:
+    enum : uint64_t { KEYS_PER_BUCKET = 3, TABLE_SLACK_PERCENT = 5, MAX_ATTEMPTS = 16, SEED_BASE = 0x243F6A8885A308D3ULL };
+
+    std::vector<uint32_t> pilots; // 버킷별 pilot (컴파일된 이미지를 쓰면 비어 있음)
+    std::vector<Slot> slots;      // 슬롯 배열 (키 수와 같음)
+    std::vector<uint32_t> remap;  // 위치 slotCount + i가 실제로 쓰는 슬롯 (tableSize - slotCount개)
+    const uint32_t* pilotData;    // 검색에 쓰는 배열 (위 벡터 또는 매핑된 이미지)
+    const Slot* slotData;
+    const uint32_t* remapData;
+    const char* blobData;
+    size_t blobSize;
+    Params params;
+
+    // [0, n) 범위로 축소 (나눗셈 대신 곱셈)
+    static inline uint64_t reduce(uint32_t x, uint64_t n) {
+        return (static_cast<uint64_t>(x) * n) >> 32;
+    }
+
+    inline uint64_t bucketOf(uint64_t h) const {
+        return reduce(static_cast<uint32_t>(h >> 32), params.bucketCount);
+    }
+
+    inline uint64_t positionOf(uint64_t h, uint32_t pilot) const {
+        return reduce(static_cast<uint32_t>(mix(h ^ (pilot * 0xD6E8FEB86659FD93ULL)) >> 32), params.tableSize);
+    }
+
+    inline uint64_t slotIndex(uint64_t position) const {
+        return position < params.slotCount ? position : remapData[position - params.slotCount];
+    }
+
+    // 모든 버킷의 pilot을 찾습니다. 실패하면 false (다른 시드로 다시 시도)
+    bool placeBuckets(const std::vector<uint64_t>& hashes, const std::vector<uint32_t>& bucketStart,
+                      const std::vector<uint32_t>& bucketKeys, const std::vector<uint32_t>& order,
+                      std::vector<uint64_t>& taken, std::vector<uint32_t>& positions) {
+        const uint64_t maxPilot = std::max<uint64_t>(1u << 20, params.tableSize * 16);
+        for (uint32_t b : order) {
+            const uint32_t begin = bucketStart[b], end = bucketStart[b + 1];
+            if (begin == end) break; // 크기순이므로 이후는 모두 빈 버킷
+
+            // 64비트 해시가 같은 키는 어떤 pilot으로도 나눌 수 없음
+            for (uint32_t i = begin; i < end; ++i) {
+                for (uint32_t j = begin; j < i; ++j) {
+                    if (hashes[bucketKeys[i]] == hashes[bucketKeys[j]]) return false;
+                }
+            }
+
+            uint64_t pilot = 0;
+            for (; pilot < maxPilot; ++pilot) {
+                positions.clear();
+                bool ok = true;
+                for (uint32_t i = begin; i < end && ok; ++i) {
+                    const uint32_t pos = static_cast<uint32_t>(positionOf(hashes[bucketKeys[i]], static_cast<uint32_t>(pilot)));
+                    if ((taken[pos >> 6] >> (pos & 63)) & 1) ok = false;
+                    else if (std::find(positions.begin(), positions.end(), pos) != positions.end()) ok = false;
+                    else positions.push_back(pos);
+                }
+                if (ok) break;
+            }
+            if (pilot == maxPilot) return false;
+
+            pilots[b] = static_cast<uint32_t>(pilot);
+            for (uint32_t pos : positions) taken[pos >> 6] |= 1ull << (pos & 63);
+        }
+        return true;
+    }
+};
+
+#endif
@@ -0,0 +1,28 @@
+"""Shared fixtures for the NemoTokenizer Python tests"""
+
+import json
+
+import pytest
+
+from nemo_tokenizer import NemoTokenizer
+
+
+VOCAB = ["[PAD]", "[UNK]", "[CLS]", "[SEP]", "hello", "world", "h", "e", "l", "o", "w", "r", "d", "##e", "##l", "##o"]
+
+
+@pytest.fixture
+def tokenizer_file(tmp_path):
+    """Write a minimal WordPiece tokenizer.json and return its path"""
+    data = {
+        "added_tokens": [{"id": i, "content": t, "special": True} for i, t in enumerate(VOCAB[:4])],
+        "decoder": {"type": "WordPiece", "prefix": "##"},
+        "model": {"type": "WordPiece", "unk_token": "[UNK]", "vocab": {t: i for i, t in enumerate(VOCAB)}},
+    }
+    path = tmp_path / "tokenizer.json"
+    path.write_text(json.dumps(data), encoding="utf-8")
+    return str(path)
+
+
+@pytest.fixture
+def tokenizer(tokenizer_file):
+    return NemoTokenizer(tokenizer_file)
@@ -0,0 +1,19 @@
+"""Batch entry points reject a single string instead of splitting it into characters"""
+
+import pytest
+
+
+@pytest.mark.parametrize("text", ["hello", b"hello"])
+def test_batch_entry_points_reject_single_string(tokenizer, text):
+    with pytest.raises(TypeError):
+        tokenizer.batch_encode(text)
+    with pytest.raises(TypeError):
+        tokenizer.batch_encode_np(text)
+    with pytest.raises(TypeError):
+        tokenizer._tokenizer.batch_encode_padded(text)
+
+
+def test_batch_entry_points_accept_sequences(tokenizer):
+    ids, offsets = tokenizer.batch_encode_np(["hello", "hello world"])
+    assert list(offsets) == [0, 3, 7]
+    assert tokenizer(["hello", "hello world"], padding=True)["input_ids"][0] == [2, 4, 3, 0]
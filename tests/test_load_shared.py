@@ -0,0 +1,20 @@
+"""load_shared error handling and shared image cleanup"""
+
+import pytest
+
+
+def test_load_shared_rejects_malformed_json(tokenizer, tokenizer_file, tmp_path):
+    image_dir = str(tmp_path / "shm")
+    (tmp_path / "shm").mkdir()
+    assert tokenizer.load_shared(tokenizer_file, image_dir)
+    expected = tokenizer.encode("hello world")
+
+    bad_file = tmp_path / "bad.json"
+    bad_file.write_text('{"model": {', encoding="utf-8")
+    with pytest.raises(ValueError):
+        tokenizer.load_shared(str(bad_file), image_dir)
+
+    # The previous model is still in use
+    assert tokenizer.encode("hello world") == expected
+    assert tokenizer.remove_shared(tokenizer_file, image_dir)
+    assert not tokenizer.remove_shared(tokenizer_file, image_dir)